@@ -0,0 +1,64 @@
+/*
+ * portisch_config_all.h - every Portisch protocol enabled
+ *
+ *  Used in place of inc/portisch_config.h by host tools which need the
+ *  complete protocol table (e.g., bench/tracegen.c), see PORTISCH_CONFIG_FILE.
+ */
+
+#define EFM8BB1_SUPPORT_PT226X_PROTOCOL			1
+#define EFM8BB1_SUPPORT_HT6P20X_PROTOCOL		1
+#define EFM8BB1_SUPPORT_HT12_PROTOCOL			1
+#define EFM8BB1_SUPPORT_Rohrmotor24_PROTOCOL	1
+#define EFM8BB1_SUPPORT_PAR56_PROTOCOL			1
+#define EFM8BB1_SUPPORT_WS_1200_PROTOCOL		1
+#define EFM8BB1_SUPPORT_ALDI_4x_PROTOCOL		1
+#define EFM8BB1_SUPPORT_SP45_PROTOCOL			1
+#define EFM8BB1_SUPPORT_DC90_PROTOCOL			1
+#define EFM8BB1_SUPPORT_DG_HOSA_PROTOCOL		1
+#define EFM8BB1_SUPPORT_HT12a_PROTOCOL			1
+#define EFM8BB1_SUPPORT_HT12_Atag_PROTOCOL		1
+#define EFM8BB1_SUPPORT_Kaku_PROTOCOL			1
+#define EFM8BB1_SUPPORT_DIO_PROTOCOL			1
+#define EFM8BB1_SUPPORT_1BYONE_PROTOCOL			1
+#define EFM8BB1_SUPPORT_Prologue_PROTOCOL		1
+#define EFM8BB1_SUPPORT_DOG_COLLAR_PROTOCOL		1
+#define EFM8BB1_SUPPORT_BY302_PROTOCOL			1
+#define EFM8BB1_SUPPORT_DT_5514_PROTOCOL		1
+#define EFM8BB1_SUPPORT_H13726_PROTOCOL			1
+
+// can be overridden to compare against the per protocol checks
+#ifndef PORTISCH_SHARED_BUCKETS
+#define PORTISCH_SHARED_BUCKETS					1
+#endif
+
+#ifndef PORTISCH_SYNC_MASKS
+#define PORTISCH_SYNC_MASKS						1
+#endif
+
+#ifndef PORTISCH_BUFFER_BUCKETS_SIZE
+#define PORTISCH_BUFFER_BUCKETS_SIZE			4
+#endif
+
+#ifndef PORTISCH_CRC8_TABLE
+#define PORTISCH_CRC8_TABLE						0
+#endif
+
+#ifndef PORTISCH_DEDUP_CACHE_SIZE
+#define PORTISCH_DEDUP_CACHE_SIZE				0
+#endif
+
+#ifndef PORTISCH_DEDUP_HOLDOFF_MS
+#define PORTISCH_DEDUP_HOLDOFF_MS				800
+#endif
+
+#ifndef PORTISCH_LEARN_TIMEOUT_MS
+#define PORTISCH_LEARN_TIMEOUT_MS				30000
+#endif
+
+#ifndef PORTISCH_LEARN_REPEATS
+#define PORTISCH_LEARN_REPEATS					2
+#endif
+
+#ifndef PORTISCH_RAW_SHIFT
+#define PORTISCH_RAW_SHIFT						3
+#endif
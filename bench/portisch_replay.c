@@ -0,0 +1,335 @@
+/*
+ * portisch_replay.c - replay recorded edge timings through the Portisch decoder on a host
+ *
+ *  Each edge of the trace is handed to capture_handler() as the capture
+ *  interrupt would, then the main loop part of main_portisch.c is emulated
+ *  (buffer_out() followed by HandleRFBucket() or Bucket_Received()).
+ *
+ *  With -l a code is only reported after that many identical frames in a row,
+ *  as by learning (0xA1/0xA9), and learning starts over after each report.
+ *
+ *  usage: portisch_replay [-m standard|advanced|bucket] [-n passes] [-e edges] [-l repeats] [-v] trace.txt
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "capture_filter.h"
+#include "capture_gate.h"
+#include "capture_timer.h"
+#include "hal.h"
+#include "portisch.h"
+#include "portisch_protocols.h"
+#include "trace.h"
+
+// bucket sniffing reports do not carry a protocol index, so count them separately
+#define BUCKET_HITS_INDEX NUM_OF_PROTOCOLS
+
+// idle time between passes so that crc debounce from previous pass has expired
+#define PASS_GAP_US 1000000
+
+static unsigned long protocolHits[NUM_OF_PROTOCOLS + 1];
+
+// identical frames required by learning, 0 to debounce as when sniffing
+static uint8_t learnRepeats = 0;
+
+#if CAPTURE_FREE_RUNNING == 1
+// free-running capture timer, capture counts since start
+static uint64_t captureTimer = 0;
+
+// runs the free-running capture timer for duration microseconds with the overflow interrupts
+// timer2_isr()/pca0_isr() would take on the way, returns the timer at the end
+static uint16_t advance_capture_timer(const uint32_t duration)
+{
+    unsigned long overflows;
+    const uint16_t timestamp = trace_timer_advance(&captureTimer, duration, &overflows);
+
+    while (overflows > 0)
+    {
+        capture_timer_overflow();
+        overflows--;
+    }
+
+    return timestamp;
+}
+#endif
+
+static double seconds_now(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static void print_decode(const unsigned int index, const bool bucketMode)
+{
+    uint8_t i;
+
+    if (bucketMode)
+    {
+        printf("%10lu us: buckets %u:", (unsigned long)host_time_us, bucket_count);
+
+        for (i = 0; i < bucket_count; i++)
+        {
+            printf(" %u", TICKS_TO_US(buckets[i]));
+        }
+
+        printf(" sync %u data", TICKS_TO_US(bucket_sync & 0x7FFF));
+
+        for (i = 0; i < actual_byte; i++)
+        {
+            printf(" %02X", RF_DATA[i]);
+        }
+    }
+    else
+    {
+        printf("%10lu us: protocol %u data", (unsigned long)host_time_us, index);
+
+        for (i = 0; i < (PROTOCOL_DATA[index].bit_count + 7) / 8; i++)
+        {
+            printf(" %02X", RF_DATA[i]);
+        }
+    }
+
+    printf("\n");
+}
+
+// emulates the RF_CODE_RFIN / RF_CODE_SNIFFING_ON / RF_CODE_SNIFFING_ON_BUCKET part of the main loop
+static unsigned long run_main_loop(const bool bucketMode, const bool verbose)
+{
+    unsigned long decodes = 0;
+    unsigned int index;
+    uint16_t bucket;
+
+    while (true)
+    {
+        if ((RF_DATA_STATUS & RF_DATA_RECEIVED_MASK) != 0)
+        {
+            index = bucketMode ? BUCKET_HITS_INDEX : (RF_DATA_STATUS & 0x7F);
+
+            protocolHits[index]++;
+            decodes++;
+
+            if (verbose)
+            {
+                print_decode(index, bucketMode);
+            }
+
+            RF_DATA_STATUS = 0;
+
+            if (learnRepeats != 0)
+            {
+                start_learning(learnRepeats);
+            }
+        }
+        else if (buffer_out(&bucket))
+        {
+            if (bucketMode)
+            {
+                Bucket_Received(bucket & 0x7FFF, (bool)((bucket & 0x8000) >> 15));
+            }
+            else
+            {
+                HandleRFBucket(bucket & 0x7FFF, (bool)((bucket & 0x8000) >> 15));
+            }
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    return decodes;
+}
+
+static void usage(const char* name)
+{
+    fprintf(stderr, "usage: %s [-m standard|advanced|bucket] [-n passes] [-e edges] [-l repeats] [-v] trace.txt\n", name);
+    exit(2);
+}
+
+int main(int argc, char** argv)
+{
+    struct trace trace;
+    unsigned long passes = 1;
+    // main loop runs after this many edges, emulates a main loop busy with something else
+    unsigned long edgesPerLoop = 1;
+    unsigned long pass;
+    unsigned long decodes = 0;
+    unsigned long edges = 0;
+    bool bucketMode = false;
+    bool verbose = false;
+    const char* modeName = "standard";
+    double start;
+    double elapsed;
+    size_t i;
+    uint16_t capture;
+    unsigned int p;
+    int opt;
+
+    sniffing_mode = STANDARD;
+
+    while ((opt = getopt(argc, argv, "m:n:e:l:v")) != -1)
+    {
+        switch (opt)
+        {
+            case 'm':
+                modeName = optarg;
+
+                if (strcmp(optarg, "standard") == 0)
+                {
+                    sniffing_mode = STANDARD;
+                }
+                else if (strcmp(optarg, "advanced") == 0)
+                {
+                    sniffing_mode = ADVANCED;
+                }
+                else if (strcmp(optarg, "bucket") == 0)
+                {
+                    bucketMode = true;
+                }
+                else
+                {
+                    usage(argv[0]);
+                }
+                break;
+            case 'n':
+                passes = strtoul(optarg, NULL, 0);
+                break;
+            case 'e':
+                edgesPerLoop = strtoul(optarg, NULL, 0);
+                break;
+            case 'l':
+                learnRepeats = strtoul(optarg, NULL, 0);
+                break;
+            case 'v':
+                verbose = true;
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+
+    if (optind + 1 != argc || passes == 0 || edgesPerLoop == 0)
+    {
+        usage(argv[0]);
+    }
+
+    if (!trace_load(argv[optind], &trace))
+    {
+        return 1;
+    }
+
+    PCA0_DoSniffing();
+    rf_state = RF_IDLE;
+
+    if (learnRepeats != 0)
+    {
+        start_learning(learnRepeats);
+    }
+
+    start = seconds_now();
+
+    for (pass = 0; pass < passes; pass++)
+    {
+        for (i = 0; i < trace.count; i++)
+        {
+            host_advance_us(trace.edges[i].duration);
+
+            // the pin has already changed to the opposite level when the edge is captured
+            host_rdata = !trace.edges[i].level;
+
+            // as timer2_isr()/pca0_isr() do, the counter restart of ignored edges has no host equivalent
+#if CAPTURE_FREE_RUNNING == 1
+            capture = capture_duration(advance_capture_timer(trace.edges[i].duration), false);
+#else
+            capture = trace.edges[i].capture;
+#endif
+
+#if CAPTURE_STORM_GATE == 1
+            if (capture_gate(capture))
+            {
+                capture_handler(capture);
+            }
+#else
+            capture_handler(capture);
+#endif
+
+            if ((i + 1) % edgesPerLoop == 0)
+            {
+                decodes += run_main_loop(bucketMode, verbose && pass == 0);
+            }
+        }
+
+        decodes += run_main_loop(bucketMode, verbose && pass == 0);
+
+        edges += trace.count;
+        host_advance_us(PASS_GAP_US);
+#if CAPTURE_FREE_RUNNING == 1
+        advance_capture_timer(PASS_GAP_US);
+#endif
+    }
+
+    elapsed = seconds_now() - start;
+
+    printf("trace:     %s (%zu edges, %.1f ms of signal)\n", argv[optind], trace.count, trace.total_us / 1000.0);
+    printf("mode:      %s, %lu passes\n", modeName, passes);
+    printf("edges:     %lu\n", edges);
+    printf("decodes:   %lu\n", decodes);
+    printf("overflows: %u (edges dropped by full buffer)\n", buffer_buckets_overflows);
+
+#if CAPTURE_GLITCH_FILTER == 1
+    // see capture_filter.h, 16 bit counter wraps around on long runs
+    printf("floor:     %u us glitch threshold at the end\n", (unsigned int)CAPTURE_COUNTS_TO_US(capture_glitch_counts));
+#if RF_STATS == 1
+    printf("glitches:  %u merged, each together with the duration after it\n", capture_glitches);
+#endif
+#endif
+#if CAPTURE_STORM_GATE == 1 && RF_STATS == 1
+    // see capture_gate.h, 16 bit counter wraps around on long runs
+    printf("gated:     %u edges ignored during noise storms\n", capture_gate_ignored);
+#endif
+    printf("elapsed:   %.6f s\n", elapsed);
+
+    if (elapsed > 0)
+    {
+        printf("edges/s:   %.0f\n", edges / elapsed);
+        printf("decodes/s: %.0f\n", decodes / elapsed);
+    }
+
+    printf("hits per protocol index:\n");
+
+    for (p = 0; p < NUM_OF_PROTOCOLS; p++)
+    {
+        printf("  %2u: %lu\n", p, protocolHits[p]);
+    }
+
+    if (bucketMode)
+    {
+        printf("  bucket: %lu\n", protocolHits[BUCKET_HITS_INDEX]);
+    }
+
+#if RF_STATS == 1
+    // what RF_CODE_STATS would report, 16 bit counters wrap around on long runs
+    printf("stats:\n");
+    printf("  edges:          %u\n", rf_stats.edges);
+    printf("  noise:          %u\n", rf_stats.noise);
+    printf("  short rejects:  %u\n", rf_stats.short_rejects);
+    printf("  debounced:      %u\n", rf_stats.debounced);
+    printf("  bucket decodes: %u\n", rf_stats.bucket_decodes);
+
+    for (p = 0; p < NUM_OF_PROTOCOLS; p++)
+    {
+        printf("  decodes %2u:     %u\n", p, rf_stats_decodes[p]);
+    }
+#endif
+
+    trace_free(&trace);
+
+    return 0;
+}
@@ -0,0 +1,244 @@
+/*
+ * rcswitch_replay.c - replay recorded edge timings through the rcswitch decoder on a host
+ *
+ *  Each edge of the trace is handed to capture_handler() as the capture
+ *  interrupt would, then the radio part of the main loop of main_rcswitch.c
+ *  is emulated (decode_frame() followed by available()).
+ *  Time spent in decode_frame() is reported separately per frame, as well as
+ *  receive_protocol() calls made and skipped thanks to the sync ratio index.
+ *
+ *  usage: rcswitch_replay [-n passes] [-v] trace.txt
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "capture_filter.h"
+#include "capture_gate.h"
+#include "capture_timer.h"
+#include "hal.h"
+#include "rcswitch.h"
+#include "trace.h"
+
+// idle time between passes
+#define PASS_GAP_US 1000000
+
+// protocols are numbered from one
+static unsigned long protocolHits[256];
+
+// time spent in decode_frame() for handed over frames
+static double decodeSeconds;
+
+#if CAPTURE_FREE_RUNNING == 1
+// free-running capture timer, capture counts since start
+static uint64_t captureTimer = 0;
+
+// runs the free-running capture timer for duration microseconds with the overflow interrupts
+// timer2_isr()/pca0_isr() would take on the way, returns the timer at the end
+static uint16_t advance_capture_timer(const uint32_t duration)
+{
+    unsigned long overflows;
+    const uint16_t timestamp = trace_timer_advance(&captureTimer, duration, &overflows);
+
+    while (overflows > 0)
+    {
+        capture_timer_overflow();
+        overflows--;
+    }
+
+    return timestamp;
+}
+#endif
+
+static double seconds_now(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// emulates the decode and report part of the main loop
+static unsigned long run_main_loop(unsigned long* frames, const bool verbose)
+{
+    unsigned long decodes = 0;
+    const double start = seconds_now();
+    uint8_t i;
+
+    if (decode_frame())
+    {
+        decodeSeconds += seconds_now() - start;
+        (*frames)++;
+    }
+
+    if (available())
+    {
+        protocolHits[get_received_protocol()]++;
+        decodes++;
+
+        if (verbose)
+        {
+            printf("%10lu us: protocol %u bits %u delay %u sync %u data",
+                (unsigned long)host_time_us, get_received_protocol(), get_received_bitlength(),
+                TICKS_TO_US(get_received_delay()), TICKS_TO_US(get_received_sync()));
+
+            for (i = 0; i < get_received_bytelength(); i++)
+            {
+                printf(" %02X", get_received_data()[i]);
+            }
+
+            printf(" average sync %u short %u long %u\n",
+                TICKS_TO_US(get_average_sync()), TICKS_TO_US(get_average_short()), TICKS_TO_US(get_average_long()));
+        }
+
+        reset_available();
+    }
+
+    return decodes;
+}
+
+static void usage(const char* name)
+{
+    fprintf(stderr, "usage: %s [-n passes] [-v] trace.txt\n", name);
+    exit(2);
+}
+
+int main(int argc, char** argv)
+{
+    struct trace trace;
+    unsigned long passes = 1;
+    unsigned long pass;
+    unsigned long decodes = 0;
+    unsigned long frames = 0;
+    unsigned long edges = 0;
+    bool verbose = false;
+    double start;
+    double elapsed;
+    size_t i;
+    uint16_t capture;
+    unsigned int p;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:v")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n':
+                passes = strtoul(optarg, NULL, 0);
+                break;
+            case 'v':
+                verbose = true;
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+
+    if (optind + 1 != argc || passes == 0)
+    {
+        usage(argv[0]);
+    }
+
+    if (!trace_load(argv[optind], &trace))
+    {
+        return 1;
+    }
+
+#if CAPTURE_STORM_GATE == 1
+    // as main_rcswitch.c does
+    capture_gate_counts = US_TO_CAPTURE_COUNTS(N_SEPARATION_LIMIT_US);
+#endif
+
+    start = seconds_now();
+
+    for (pass = 0; pass < passes; pass++)
+    {
+        for (i = 0; i < trace.count; i++)
+        {
+            host_advance_us(trace.edges[i].duration);
+
+            // the pin has already changed to the opposite level when the edge is captured
+            host_rdata = !trace.edges[i].level;
+
+            // as timer2_isr()/pca0_isr() do, the counter restart of ignored edges has no host equivalent
+#if CAPTURE_FREE_RUNNING == 1
+            capture = capture_duration(advance_capture_timer(trace.edges[i].duration), false);
+#else
+            capture = trace.edges[i].capture;
+#endif
+
+#if CAPTURE_STORM_GATE == 1
+            if (capture_gate(capture))
+            {
+                capture_handler(capture);
+            }
+#else
+            capture_handler(capture);
+#endif
+
+            decodes += run_main_loop(&frames, verbose && pass == 0);
+        }
+
+        edges += trace.count;
+        host_advance_us(PASS_GAP_US);
+#if CAPTURE_FREE_RUNNING == 1
+        advance_capture_timer(PASS_GAP_US);
+#endif
+    }
+
+    elapsed = seconds_now() - start;
+
+    printf("trace:     %s (%zu edges, %.1f ms of signal)\n", argv[optind], trace.count, trace.total_us / 1000.0);
+    printf("passes:    %lu\n", passes);
+    printf("edges:     %lu\n", edges);
+    printf("frames:    %lu\n", frames);
+    printf("decodes:   %lu\n", decodes);
+
+#if CAPTURE_GLITCH_FILTER == 1
+    // see capture_filter.h, 16 bit counter wraps around on long runs
+    printf("floor:     %u us glitch threshold at the end\n", (unsigned int)CAPTURE_COUNTS_TO_US(capture_glitch_counts));
+#if RF_STATS == 1
+    printf("glitches:  %u merged, each together with the duration after it\n", capture_glitches);
+#endif
+#endif
+#if CAPTURE_STORM_GATE == 1 && RF_STATS == 1
+    // see capture_gate.h, 16 bit counter wraps around on long runs
+    printf("gated:     %u edges ignored during noise storms\n", capture_gate_ignored);
+#endif
+    printf("elapsed:   %.6f s\n", elapsed);
+
+    if (elapsed > 0)
+    {
+        printf("edges/s:   %.0f\n", edges / elapsed);
+        printf("frames/s:  %.0f\n", frames / elapsed);
+    }
+
+    if (frames > 0)
+    {
+        printf("decode:    %.1f ns/frame\n", decodeSeconds * 1e9 / frames);
+    }
+
+    printf("receive_protocol calls: %lu, avoided by sync ratio index: %lu",
+        rcswitchProtocolCalls, rcswitchProtocolCallsAvoided);
+
+    if (rcswitchProtocolCalls + rcswitchProtocolCallsAvoided > 0)
+    {
+        printf(" (%.1f%%)", 100.0 * rcswitchProtocolCallsAvoided / (rcswitchProtocolCalls + rcswitchProtocolCallsAvoided));
+    }
+
+    printf("\n");
+
+    printf("hits per protocol:\n");
+
+    for (p = 1; p <= numProto; p++)
+    {
+        printf("  %2u: %lu\n", p, protocolHits[p]);
+    }
+
+    trace_free(&trace);
+
+    return 0;
+}
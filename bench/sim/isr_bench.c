@@ -0,0 +1,430 @@
+/*
+ * isr_bench.c - measures cycles spent in capture_handler() and the decoder main loop
+ *
+ *  Built by 'make sim-bench' once for Portisch (BENCH_PORTISCH) and once for
+ *  rcswitch (BENCH_RCSWITCH) and run in the ucsim s51 simulator that ships with sdcc.
+ *  Edges from a trace (see sim_trace.h generated from bench/traces) are injected
+ *  exactly as timer2_isr()/pca0_isr() would, i.e. the receiver pin is set and
+ *  capture_handler() is called with the captured count (the difference of two
+ *  timestamps of the free-running timer with FREE_RUNNING=1, see capture_timer.h).
+ *
+ *  The passthrough image (BENCH_PASSTHROUGH) instead measures how long the mirroring
+ *  interrupt of main_passthrough.c takes from the edge to the uart tx pin. s51 has neither
+ *  the timer 2 capture of the OB38S003 nor the PCA of the EFM8BB1, so external interrupt 0
+ *  of the simulated 8052 runs the same mirror_rdata_to_uart_tx() in their place.
+ *  For comparison it also times one pass of the polling loop passthrough used before,
+ *  which bounded the delay from an edge to the output (the jitter) instead.
+ *
+ *  Timer 0 counts machine cycles while each call runs, and the result is printed
+ *  over the hardware uart (attached to a file by s51).
+ */
+
+#if !defined(TARGET_BOARD_EFM8BB1) && !defined(TARGET_BOARD_OB38S003) && !defined(TARGET_BOARD_EFM8BB1LCB)
+    #error Please define TARGET_BOARD in makefile
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "capture_gate.h"
+#include "capture_timer.h"
+#include "hal.h"
+#include "timer_interrupts.h"
+
+#if defined(TARGET_BOARD_EFM8BB1) || defined(TARGET_BOARD_EFM8BB1LCB)
+    // these are just a difference in naming convention
+    #define SBUF SBUF0
+    #define SCON SCON0
+#endif
+
+#if defined(BENCH_PORTISCH)
+    #include "portisch.h"
+
+    // STANDARD or ADVANCED, bucket sniffing is not measured
+    #ifndef SIM_SNIFFING_MODE
+        #define SIM_SNIFFING_MODE STANDARD
+    #endif
+#elif defined(BENCH_RCSWITCH)
+    #include "rcswitch.h"
+#elif defined(BENCH_PASSTHROUGH)
+    // external interrupt 0 of the 8052 (bit addresses of TCON, IE and P3.2)
+    __sbit __at (0x88) SIM_IT0;
+    __sbit __at (0xA8) SIM_EX0;
+    __sbit __at (0xB2) SIM_INT0_PIN;
+#else
+    #error Please define BENCH_PORTISCH, BENCH_RCSWITCH or BENCH_PASSTHROUGH
+#endif
+
+// generated from a trace file by bench/sim/trace_to_header.awk
+#include "sim_trace.h"
+
+struct cycle_stats
+{
+    uint16_t min;
+    uint16_t max;
+    uint32_t sum;
+    uint16_t count;
+    // calls which took longer than timer 0 can count
+    uint16_t overflows;
+};
+
+__xdata struct cycle_stats isrStats;
+__xdata struct cycle_stats loopStats;
+#if defined(BENCH_PORTISCH)
+// the debounce crc alone, once for every byte value
+__xdata struct cycle_stats crcStats;
+#endif
+
+// cycles spent by starting and stopping the timer alone
+uint16_t measureOverhead;
+
+#if defined(BENCH_PASSTHROUGH)
+// edges after which the uart tx pin did not match the receiver pin
+__xdata uint16_t mirrorErrors;
+
+// same body as timer2_isr()/pca0_isr() of main_passthrough.c
+void sim_edge_isr(void) __interrupt (0)
+{
+    mirror_rdata_to_uart_tx();
+
+    // stops the cycle count right after the output pin was written
+    TR0 = 0;
+}
+
+// one pass of the main loop of main_passthrough.c before edges were mirrored by interrupt,
+// an edge waited for up to one pass before it was seen
+void polled_pass(void)
+{
+    static bool rdataLevelOld;
+    static bool rdataLevelNew = false;
+    static bool tdataLevelOld;
+    static bool tdataLevelNew = false;
+
+    refresh_watchdog();
+
+    rdataLevelOld = rdataLevelNew;
+    rdataLevelNew = rdata_level();
+
+    if (rdataLevelOld != rdataLevelNew)
+    {
+        if (rdataLevelNew)
+        {
+            uart_tx_pin_on();
+        } else {
+            uart_tx_pin_off();
+        }
+    }
+
+    tdataLevelOld = tdataLevelNew;
+    tdataLevelNew = uart_rx_pin_level();
+
+    if (tdataLevelOld != tdataLevelNew)
+    {
+        if (tdataLevelNew)
+        {
+            tdata_on();
+        } else {
+            tdata_off();
+        }
+    }
+}
+#endif
+
+unsigned char __sdcc_external_startup(void)
+{
+    disable_global_interrupts();
+
+    return 0;
+}
+
+void stats_init(__xdata struct cycle_stats* stats)
+{
+    stats->min = 0xFFFF;
+    stats->max = 0;
+    stats->sum = 0;
+    stats->count = 0;
+    stats->overflows = 0;
+}
+
+void stats_add(__xdata struct cycle_stats* stats, uint16_t cycles)
+{
+    if (TF0)
+    {
+        TF0 = 0;
+        stats->overflows++;
+        return;
+    }
+
+    cycles -= measureOverhead;
+
+    if (cycles < stats->min)
+    {
+        stats->min = cycles;
+    }
+
+    if (cycles > stats->max)
+    {
+        stats->max = cycles;
+    }
+
+    stats->sum += cycles;
+    stats->count++;
+}
+
+static inline void cycles_start(void)
+{
+    TH0 = 0;
+    TL0 = 0;
+    TR0 = 1;
+}
+
+static inline uint16_t cycles_stop(void)
+{
+    TR0 = 0;
+
+    return (TH0 << 8) | TL0;
+}
+
+#if !defined(BENCH_PASSTHROUGH)
+// the decoder specific part of the main loop
+// returns false if there was nothing left to do
+bool main_loop_iteration(void)
+{
+#if defined(BENCH_PORTISCH)
+    uint16_t bucket;
+
+    if ((RF_DATA_STATUS & RF_DATA_RECEIVED_MASK) != 0)
+    {
+        RF_DATA_STATUS = 0;
+        return true;
+    }
+
+    if (buffer_out(&bucket))
+    {
+        HandleRFBucket(bucket & 0x7FFF, (bool)((bucket & 0x8000) >> 15));
+        return true;
+    }
+
+    return false;
+#elif defined(BENCH_RCSWITCH)
+    if (decode_frame())
+    {
+        return true;
+    }
+
+    if (available())
+    {
+        reset_available();
+        return true;
+    }
+
+    return false;
+#endif
+}
+#endif
+
+void sim_putc(const char c)
+{
+    SBUF = c;
+
+    while (!TI);
+
+    TI = 0;
+}
+
+void sim_puts(const char* s)
+{
+    while (*s)
+    {
+        sim_putc(*s++);
+    }
+}
+
+void sim_putu32(uint32_t value)
+{
+    char digits[10];
+    uint8_t count = 0;
+
+    do
+    {
+        digits[count++] = '0' + (value % 10);
+        value /= 10;
+    } while (value != 0);
+
+    while (count > 0)
+    {
+        sim_putc(digits[--count]);
+    }
+}
+
+void print_stats(const char* name, __xdata struct cycle_stats* stats)
+{
+    sim_puts(name);
+    sim_puts(" calls ");
+    sim_putu32(stats->count);
+    sim_puts(" min ");
+    sim_putu32(stats->count ? stats->min : 0);
+    sim_puts(" avg ");
+    sim_putu32(stats->count ? stats->sum / stats->count : 0);
+    sim_puts(" max ");
+    sim_putu32(stats->max);
+    sim_puts(" overflows ");
+    sim_putu32(stats->overflows);
+    sim_puts("\r\n");
+}
+
+// the script places a breakpoint here to stop the simulator
+void bench_done(void)
+{
+    while (true);
+}
+
+void main(void)
+{
+    uint16_t index;
+    uint16_t cycles;
+#if !defined(BENCH_PASSTHROUGH)
+    uint16_t capture;
+    bool busy;
+#if CAPTURE_FREE_RUNNING == 1
+    uint16_t timestamp = 0;
+#endif
+#endif
+
+    // timer 0 in 16-bit mode counts machine cycles
+    TMOD = (TMOD & 0xF0) | 0x01;
+
+    cycles_start();
+    cycles = cycles_stop();
+    measureOverhead = cycles;
+
+    stats_init(&isrStats);
+    stats_init(&loopStats);
+#if defined(BENCH_PORTISCH)
+    stats_init(&crcStats);
+
+    // PORTISCH_CRC8_TABLE changes this part of the main loop only
+    for (index = 0; index < 256; index++)
+    {
+        cycles_start();
+        Compute_CRC8_Simple_OneByte(index);
+        cycles = cycles_stop();
+        stats_add(&crcStats, cycles);
+    }
+#endif
+
+#if defined(BENCH_PORTISCH)
+    sniffing_mode = SIM_SNIFFING_MODE;
+    PCA0_DoSniffing();
+    rf_state = RF_IDLE;
+#elif defined(BENCH_RCSWITCH) && CAPTURE_STORM_GATE == 1
+    // as main_rcswitch.c does
+    capture_gate_counts = US_TO_CAPTURE_COUNTS(N_SEPARATION_LIMIT_US);
+#elif defined(BENCH_PASSTHROUGH)
+    mirrorErrors = 0;
+
+    // falling edge triggered
+    SIM_IT0 = 1;
+    SIM_INT0_PIN = 1;
+    SIM_EX0 = 1;
+    enable_global_interrupts();
+#endif
+
+    for (index = 0; index < SIM_TRACE_EDGES; index++)
+    {
+        // the pin has already changed to the opposite level when the edge is captured
+        RDATA = !sim_trace_level[index];
+
+#if defined(BENCH_PASSTHROUGH)
+        cycles_start();
+
+        // the edge, the interrupt stops the timer once the output is written
+        SIM_INT0_PIN = 0;
+
+        while (TR0);
+
+        cycles = (TH0 << 8) | TL0;
+        stats_add(&isrStats, cycles);
+
+        SIM_INT0_PIN = 1;
+
+        if (UART_TX_PIN != RDATA)
+        {
+            mirrorErrors++;
+        }
+
+        // the pass that sees this edge
+        cycles_start();
+        polled_pass();
+        cycles = cycles_stop();
+        stats_add(&loopStats, cycles);
+#else
+#if CAPTURE_FREE_RUNNING == 1
+        // a wrap around of the free-running timer had its own overflow interrupt before the edge
+        timestamp += sim_trace_counts[index];
+
+        if (timestamp < sim_trace_counts[index])
+        {
+            capture_timer_overflow();
+        }
+#endif
+
+        cycles_start();
+#if CAPTURE_FREE_RUNNING == 1
+        capture = capture_duration(timestamp, false);
+#else
+        capture = sim_trace_counts[index];
+#endif
+#if CAPTURE_STORM_GATE == 1
+        // as timer2_isr()/pca0_isr() do, see capture_gate.h
+        if (capture_gate(capture))
+        {
+            capture_handler(capture);
+        }
+        else
+        {
+            clear_pca_counter();
+        }
+#else
+        capture_handler(capture);
+#endif
+        cycles = cycles_stop();
+        stats_add(&isrStats, cycles);
+
+        do
+        {
+            cycles_start();
+            busy = main_loop_iteration();
+            cycles = cycles_stop();
+            stats_add(&loopStats, cycles);
+        } while (busy);
+#endif
+    }
+
+    // timer 1 8-bit autoreload is the classic 8051 uart baud rate source, which is what s51 simulates
+    TMOD = (TMOD & 0x0F) | 0x20;
+    TH1 = 0xFF;
+    TL1 = 0xFF;
+    TR1 = 1;
+    SCON = 0x50;
+    TI = 0;
+
+    sim_puts("edges ");
+    sim_putu32(SIM_TRACE_EDGES);
+    sim_puts("\r\n");
+#if defined(BENCH_PASSTHROUGH)
+    print_stats("edge_to_output", &isrStats);
+    print_stats("polled_pass", &loopStats);
+    sim_puts("mirror errors ");
+    sim_putu32(mirrorErrors);
+    sim_puts("\r\n");
+#else
+    print_stats("capture_handler", &isrStats);
+    print_stats("main_loop", &loopStats);
+#if defined(BENCH_PORTISCH)
+    print_stats("crc8", &crcStats);
+#endif
+#endif
+
+    bench_done();
+}
@@ -0,0 +1,154 @@
+#!/bin/sh
+# measure.sh - firmware sizes and simulator cycle counts per board, option setting and revision
+#
+#  usage: measure.sh [-r revision]... [-c config.h] [-s "NAME=value ..."]... [make variable=value ...]
+#
+#  For every board in BOARDS (default "OB38S003 EFM8BB1") the firmware images
+#  and the sim-bench images are built with sdcc in a directory of their own,
+#  so the working tree is left alone. Printed are code, xram and free stack
+#  bytes from the .mem file of each firmware image, followed by the output of
+#  run_isr_bench.sh for the sim-bench images.
+#
+#  -r  builds a git revision instead of the working tree, give it more than
+#      once to compare revisions (e.g. -r HEAD~1 -r HEAD)
+#  -c  starts from another protocol selection than inc/portisch_config.h,
+#      e.g. -c bench/portisch_config_all.h
+#  -s  changes settings of the selection, give it more than once to build each
+#      variant, e.g. -s PORTISCH_CRC8_TABLE=0 -s PORTISCH_CRC8_TABLE=1
+#
+#  The sim-bench images are run even if the firmware images do not fit the flash,
+#  which is the case with every protocol enabled.
+#  Remaining arguments are passed to make, e.g. SIM_TRACE=... or FREE_RUNNING=1.
+#  Set S51 in the environment if the simulator is not in the path, WORK to keep
+#  the build directories (default a temporary directory that is removed).
+
+ROOT=$(cd "$(dirname "$0")/../.." && pwd)
+BOARDS=${BOARDS:-"OB38S003 EFM8BB1"}
+REVISIONS=
+CONFIG_BASE=
+# one variant per line
+VARIANTS=
+
+while getopts "r:c:s:" OPTION; do
+    case $OPTION in
+        r) REVISIONS="$REVISIONS $OPTARG" ;;
+        c) CONFIG_BASE=$OPTARG ;;
+        s) VARIANTS="$VARIANTS$OPTARG
+" ;;
+        *) echo "usage: $0 [-r revision]... [-c config.h] [-s \"NAME=value ...\"]... [make variable=value ...]" >&2
+           exit 2 ;;
+    esac
+done
+shift $((OPTIND - 1))
+
+if [ -n "$WORK" ]; then
+    mkdir -p "$WORK"
+else
+    WORK=$(mktemp -d)
+    trap 'rm -rf "$WORK"' EXIT
+fi
+
+# code, xram and stack of each firmware image
+print_sizes()
+{
+    for MEM in "$1"/main_*.mem; do
+        awk -v image="$(basename "$MEM" .mem)" '
+            /^Stack starts at/     { stack = $(NF - 2) }
+            /EXTERNAL RAM/         { xram = $(NF - 1); xram_max = $NF }
+            /ROM\/EPROM\/FLASH/    { code = $(NF - 1); code_max = $NF }
+            END { printf("  %-26s code %5d / %5d  xram %4d / %4d  stack %3d\n", image, code, code_max, xram, xram_max, stack) }
+        ' "$MEM"
+    done
+}
+
+# builds and measures the sources in $1 for board $2, label $3, with the protocol selection $4 if not empty
+measure()
+{
+    OUT="$WORK/$(echo "$3" | tr ' /=' '___')/$2"
+    mkdir -p "$OUT"
+
+    if [ -n "$4" ]; then
+        FLAGS="PROJECT_FLAGS=-DPORTISCH_CONFIG_FILE='\"$4\"'"
+    else
+        FLAGS="PROJECT_FLAGS="
+    fi
+
+    echo "== $2 $3"
+
+    if make -s -C "$1" TARGET_BOARD="$2" BUILD_DIR="$OUT/build" OBJECT_DIR="$OUT/object" "$FLAGS" $MAKE_VARIABLES all > "$OUT/build.log" 2>&1; then
+        print_sizes "$OUT/build"
+    else
+        echo "  firmware build failed, see $OUT/build.log"
+    fi
+
+    if ! make -s -C "$1" TARGET_BOARD="$2" BUILD_DIR="$OUT/build" OBJECT_DIR="$OUT/object" "$FLAGS" $MAKE_VARIABLES sim-bench > "$OUT/sim.log" 2>&1; then
+        echo "  sim-bench failed, see $OUT/sim.log"
+        return
+    fi
+
+    # only the results of run_isr_bench.sh, not the compiler output before them
+    awk '/ kHz:$/ { found = 1 } found' "$OUT/sim.log"
+}
+
+# working tree or each revision, for each board and setting value
+MAKE_VARIABLES="$*"
+
+for REVISION in ${REVISIONS:-working-tree}; do
+    if [ "$REVISION" = working-tree ]; then
+        SOURCE=$ROOT
+    else
+        SOURCE="$WORK/source_$(echo "$REVISION" | tr ' /~^' '____')"
+        mkdir -p "$SOURCE"
+
+        if ! git -C "$ROOT" archive --format=tar "$REVISION" | tar -x -C "$SOURCE"; then
+            echo "$REVISION: not a revision" >&2
+            exit 1
+        fi
+    fi
+
+    for BOARD in $BOARDS; do
+        if [ -z "$CONFIG_BASE" ] && [ -z "$VARIANTS" ]; then
+            measure "$SOURCE" "$BOARD" "$REVISION" ""
+            continue
+        fi
+
+        # selection is taken from the revision as well, inc/portisch_config.h without its #if
+        if [ -n "$CONFIG_BASE" ]; then
+            BASE="$SOURCE/$CONFIG_BASE"
+        else
+            BASE="$SOURCE/inc/portisch_config.h"
+        fi
+
+        if [ ! -f "$BASE" ]; then
+            echo "$BASE: not found" >&2
+            exit 1
+        fi
+
+        # without -s a single empty variant builds the selection as it is
+        printf '%s\n' "$VARIANTS" | while IFS= read -r VARIANT; do
+            [ -z "$VARIANT" ] && [ -n "$VARIANTS" ] && continue
+
+            LABEL=$(echo "$REVISION $CONFIG_BASE $VARIANT" | tr -s ' ' | sed 's/ $//')
+            CONFIG="$WORK/config_$(echo "$LABEL" | tr ' /~^=' '_____').h"
+
+            if [ -n "$CONFIG_BASE" ]; then
+                cat "$BASE" > "$CONFIG"
+            else
+                awk '/^#else/ { found = 1; next } /^#endif/ { found = 0 } found' "$BASE" > "$CONFIG"
+            fi
+
+            for ASSIGNMENT in $VARIANT; do
+                NAME=${ASSIGNMENT%%=*}
+
+                if ! grep -q "^#define $NAME[[:space:]]" "$CONFIG"; then
+                    echo "$NAME: not a setting of $BASE" >&2
+                    exit 1
+                fi
+
+                sed "s/^#define $NAME[[:space:]].*/#define $NAME ${ASSIGNMENT#*=}/" "$CONFIG" > "$CONFIG.new" && mv "$CONFIG.new" "$CONFIG"
+            done
+
+            measure "$SOURCE" "$BOARD" "$LABEL" "$CONFIG"
+        done || exit 1
+    done
+done
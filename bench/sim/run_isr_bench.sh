@@ -0,0 +1,48 @@
+#!/bin/sh
+# run_isr_bench.sh - runs isr_bench images in the s51 simulator and prints cycle counts
+#
+#  usage: run_isr_bench.sh <mcu_freq_khz> image.ihx [image.ihx ...]
+#
+#  Each image must have its linker map (image.map) next to it, the address of
+#  bench_done() is taken from there to stop the simulator.
+#
+#  s51 models a classic 12 clock 8051, cycles are machine cycles of that core.
+#  Times are estimated assuming one machine cycle per clock on the single cycle
+#  cores (OB38S003, EFM8BB1), so compare results relative to each other.
+
+S51=${S51:-s51}
+
+if [ $# -lt 2 ]; then
+    echo "usage: $0 <mcu_freq_khz> image.ihx [image.ihx ...]" >&2
+    exit 2
+fi
+
+FREQ_KHZ=$1
+shift
+
+for IMAGE in "$@"; do
+    MAP="${IMAGE%.ihx}.map"
+    SERIAL_OUT="${IMAGE%.ihx}.sim.txt"
+
+    ADDRESS=$(awk '$1 == "C:" && $3 == "_bench_done" { print "0x" $2 }' "$MAP")
+
+    if [ -z "$ADDRESS" ]; then
+        echo "$MAP: _bench_done not found" >&2
+        exit 1
+    fi
+
+    rm -f "$SERIAL_OUT"
+
+    printf 'break %s\nrun\nquit\n' "$ADDRESS" | "$S51" -t 8052 -s "$SERIAL_OUT" "$IMAGE" > /dev/null
+
+    echo "$(basename "$IMAGE") at $FREQ_KHZ kHz:"
+
+    tr -d '\r' < "$SERIAL_OUT" | awk -v khz="$FREQ_KHZ" '
+        $2 == "calls" {
+            printf("  %-16s calls %6d  cycles min %6d avg %6d max %6d  (us min %.1f avg %.1f max %.1f)  overflows %d\n",
+                $1, $3, $5, $7, $9, $5 * 1000 / khz, $7 * 1000 / khz, $9 * 1000 / khz, $11)
+            next
+        }
+        { print "  " $0 }
+    '
+done
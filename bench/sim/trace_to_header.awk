@@ -0,0 +1,63 @@
+# trace_to_header.awk - converts an edge trace (see bench/README.md) into sim_trace.h
+#
+#  durations are converted from microseconds into capture counts of the target:
+#  awk -v khz=16000 -v prescaler=24 -f trace_to_header.awk trace.txt > sim_trace.h
+
+BEGIN {
+    count = 0
+}
+
+# strip comments and skip empty lines
+{
+    sub(/#.*/, "")
+}
+
+NF == 0 {
+    next
+}
+
+NF != 2 || ($1 != "0" && $1 != "1") {
+    printf("line %d: expected '<level 0|1> <duration_us>'\n", NR) > "/dev/stderr"
+    failed = 1
+    exit 1
+}
+
+{
+    counts = int($2 * khz / (1000 * prescaler))
+
+    if (counts > 65535) {
+        counts = 65535
+    }
+
+    level[count] = $1
+    duration[count] = counts
+    count++
+}
+
+END {
+    if (failed) {
+        exit 1
+    }
+
+    print "// generated by bench/sim/trace_to_header.awk, do not edit"
+    print "#ifndef SIM_TRACE_H_"
+    print "#define SIM_TRACE_H_"
+    print ""
+    printf("#define SIM_TRACE_EDGES %d\n", count)
+    print ""
+
+    print "__code static const bool sim_trace_level[SIM_TRACE_EDGES] = {"
+    for (i = 0; i < count; i++) {
+        printf("    %s,\n", level[i])
+    }
+    print "};"
+    print ""
+
+    print "__code static const uint16_t sim_trace_counts[SIM_TRACE_EDGES] = {"
+    for (i = 0; i < count; i++) {
+        printf("    %d,\n", duration[i])
+    }
+    print "};"
+    print ""
+    print "#endif"
+}
@@ -0,0 +1,148 @@
+/*
+ * trace.c - recorded radio edge timings for host replay
+ */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "capture_ticks.h"
+#include "trace.h"
+
+// same rounding as US_TO_CAPTURE_COUNTS() but without overflow for long gaps
+static uint64_t capture_counts_wide(const uint32_t duration)
+{
+    return ((uint64_t)duration * (MCU_FREQ / 1000UL) + CAPTURE_PRESCALER * 500UL) / (CAPTURE_PRESCALER * 1000UL);
+}
+
+static uint16_t capture_counts(const uint32_t duration)
+{
+    const uint64_t counts = capture_counts_wide(duration);
+
+    return counts > 0xFFFF ? 0xFFFF : counts;
+}
+
+static bool trace_append(struct trace* trace, size_t* capacity, const bool level, const uint32_t duration, const uint64_t timestamp)
+{
+    struct trace_edge* grown;
+
+    if (trace->count == *capacity)
+    {
+        *capacity = *capacity ? *capacity * 2 : 1024;
+        grown = realloc(trace->edges, *capacity * sizeof(*grown));
+
+        if (grown == NULL)
+        {
+            return false;
+        }
+
+        trace->edges = grown;
+    }
+
+    trace->edges[trace->count].level    = level;
+    trace->edges[trace->count].duration = duration;
+    trace->edges[trace->count].timestamp = timestamp;
+    trace->edges[trace->count].capture = capture_counts(duration);
+    trace->count++;
+    trace->total_us += duration;
+
+    return true;
+}
+
+bool trace_load(const char* path, struct trace* trace)
+{
+    char line[256];
+    size_t capacity = 0;
+    unsigned long lineNumber = 0;
+    unsigned int level;
+    unsigned long duration;
+    unsigned long long timestamp;
+    uint64_t nextTimestamp = 0;
+    int fields;
+    char* comment;
+    char* p;
+    FILE* file;
+
+    memset(trace, 0, sizeof(*trace));
+
+    file = fopen(path, "r");
+
+    if (file == NULL)
+    {
+        perror(path);
+        return false;
+    }
+
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        lineNumber++;
+
+        comment = strchr(line, '#');
+
+        if (comment != NULL)
+        {
+            *comment = '\0';
+        }
+
+        // skip blank lines
+        for (p = line; isspace((unsigned char)*p); p++);
+
+        if (*p == '\0')
+        {
+            continue;
+        }
+
+        fields = sscanf(p, "%u %lu %llu", &level, &duration, &timestamp);
+
+        if (fields < 2 || level > 1)
+        {
+            fprintf(stderr, "%s:%lu: expected '<level> <duration> [<timestamp>]'\n", path, lineNumber);
+            fclose(file);
+            trace_free(trace);
+            return false;
+        }
+
+        if (fields == 2)
+        {
+            timestamp = nextTimestamp;
+        }
+        else if (trace->count > 0 && timestamp < trace->edges[trace->count - 1].timestamp)
+        {
+            fprintf(stderr, "%s:%lu: timestamp goes backwards\n", path, lineNumber);
+            fclose(file);
+            trace_free(trace);
+            return false;
+        }
+
+        nextTimestamp = timestamp + duration;
+
+        if (!trace_append(trace, &capacity, level, duration, timestamp))
+        {
+            fprintf(stderr, "%s: out of memory\n", path);
+            fclose(file);
+            trace_free(trace);
+            return false;
+        }
+    }
+
+    fclose(file);
+
+    return true;
+}
+
+void trace_free(struct trace* trace)
+{
+    free(trace->edges);
+    memset(trace, 0, sizeof(*trace));
+}
+
+uint16_t trace_timer_advance(uint64_t* timer, const uint32_t duration, unsigned long* overflows)
+{
+    const uint64_t previous = *timer;
+
+    *timer += capture_counts_wide(duration);
+    *overflows = (unsigned long)((*timer >> 16) - (previous >> 16));
+
+    return (uint16_t)*timer;
+}
@@ -0,0 +1,45 @@
+/*
+ * trace.h - recorded radio edge timings for host replay
+ *
+ *  A trace is a text file with one level per line:
+ *      <level> <duration in microseconds> [<timestamp in microseconds>]
+ *  where level is 1 (high) or 0 (low) and duration is how long the
+ *  receiver output stayed at that level. The optional timestamp is the time
+ *  the level started (e.g., from a logic analyzer export), otherwise it
+ *  continues from the previous line. '#' starts a comment.
+ */
+
+#ifndef BENCH_TRACE_H
+#define BENCH_TRACE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct trace_edge
+{
+    bool     level;
+    uint32_t duration;
+    // start of this level in microseconds
+    uint64_t timestamp;
+    // duration in counts of the capture timer (MCU_FREQ / CAPTURE_PRESCALER), 16 bit like the hardware
+    uint16_t capture;
+};
+
+struct trace
+{
+    struct trace_edge* edges;
+    size_t count;
+    // sum of all durations in microseconds
+    uint64_t total_us;
+};
+
+// returns false and prints the reason to stderr on failure
+bool trace_load(const char* path, struct trace* trace);
+void trace_free(struct trace* trace);
+
+// advances a free-running 16 bit capture timer, kept in *timer as capture counts since start,
+// by duration microseconds and returns its value then together with the overflows on the way
+uint16_t trace_timer_advance(uint64_t* timer, const uint32_t duration, unsigned long* overflows);
+
+#endif // BENCH_TRACE_H
@@ -0,0 +1,579 @@
+/*
+ * tracegen.c - generate synthetic edge traces from the decoder protocol tables
+ *
+ *  Portisch protocols are taken from PROTOCOL_DATA in inc/portisch_protocols.h
+ *  (built with every protocol enabled, see bench/portisch_config_all.h) and
+ *  rcswitch protocols from protocols[] in src/rcswitch.c, so traces always
+ *  follow the timings the decoders are built with.
+ *
+ *  The trace is written to stdout in the format read by trace_load().
+ *
+ *  usage: tracegen [options] portisch:<name> | rcswitch:<number> | idle
+ *         tracegen -l
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "portisch_protocols.h"
+#include "rcswitch.h"
+
+// longest data accepted with -d, in hex digits
+#define MAX_DATA_DIGITS 32
+
+// width of inter-frame noise pulses in microseconds
+#define NOISE_MIN_US 30
+#define NOISE_MAX_US 300
+
+// receiver output without a transmitter (target idle), two thirds are glitches up to IDLE_GLITCH_MAX_US
+#define IDLE_GLITCH_MIN_US 2
+#define IDLE_GLITCH_MAX_US 60
+#define IDLE_LEVEL_MAX_US  1500
+
+// same order and conditions as PROTOCOL_DATA[]
+static const char* const portischNames[] =
+{
+#if EFM8BB1_SUPPORT_PT226X_PROTOCOL == 1
+    "PT226X",
+#endif
+#if EFM8BB1_SUPPORT_Rohrmotor24_PROTOCOL == 1
+    "Rohrmotor24",
+#endif
+#if EFM8BB1_SUPPORT_PAR56_PROTOCOL == 1
+    "PAR56",
+#endif
+#if EFM8BB1_SUPPORT_WS_1200_PROTOCOL == 1
+    "WS_1200",
+#endif
+#if EFM8BB1_SUPPORT_ALDI_4x_PROTOCOL == 1
+    "ALDI_4x",
+#endif
+#if EFM8BB1_SUPPORT_HT6P20X_PROTOCOL == 1
+    "HT6P20X",
+#endif
+#if EFM8BB1_SUPPORT_HT12_PROTOCOL == 1
+    "HT12",
+#endif
+#if EFM8BB1_SUPPORT_HT12a_PROTOCOL == 1
+    "HT12a",
+#endif
+#if EFM8BB1_SUPPORT_HT12_Atag_PROTOCOL == 1
+    "HT12b",
+    "HT12c",
+#endif
+#if EFM8BB1_SUPPORT_SP45_PROTOCOL == 1
+    "SP45",
+#endif
+#if EFM8BB1_SUPPORT_DC90_PROTOCOL == 1
+    "DC90",
+#endif
+#if EFM8BB1_SUPPORT_DG_HOSA_PROTOCOL == 1
+    "DG_HOSA",
+#endif
+#if EFM8BB1_SUPPORT_Kaku_PROTOCOL == 1
+    "KaKu",
+#endif
+#if EFM8BB1_SUPPORT_DIO_PROTOCOL == 1
+    "DIO_emg",
+#endif
+#if EFM8BB1_SUPPORT_1BYONE_PROTOCOL == 1
+    "OneByOne",
+#endif
+#if EFM8BB1_SUPPORT_Prologue_PROTOCOL == 1
+    "Prologue",
+#endif
+#if EFM8BB1_SUPPORT_DOG_COLLAR_PROTOCOL == 1
+    "DogCollar",
+#endif
+#if EFM8BB1_SUPPORT_BY302_PROTOCOL == 1
+    "BY302",
+#endif
+#if EFM8BB1_SUPPORT_DT_5514_PROTOCOL == 1
+    "DT_5514",
+#endif
+#if EFM8BB1_SUPPORT_H13726_PROTOCOL == 1
+    "H13726",
+#endif
+};
+
+_Static_assert(ARRAY_LENGTH(portischNames) == NUM_OF_PROTOCOLS, "portischNames[] does not match PROTOCOL_DATA[]");
+
+struct options
+{
+    unsigned int repeats;
+    unsigned int bursts;
+    uint32_t gap;
+    uint32_t jitter;
+    double skew;
+    unsigned int noise;
+    bool dropFirstSync;
+    bool timestamps;
+};
+
+// consecutive durations of the same level are merged before jitter is applied,
+// the receiver can not output two separate levels of the same polarity either
+struct emitter
+{
+    const struct options* options;
+    bool pending;
+    bool level;
+    uint32_t duration;
+    uint64_t time;
+};
+
+static uint32_t randomState;
+
+// xorshift32, so traces do not depend on the C library for a given seed
+static uint32_t random_next(void)
+{
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+
+    return randomState;
+}
+
+// uniform in [min, max]
+static int32_t random_range(const int32_t min, const int32_t max)
+{
+    return min + (int32_t)(random_next() % (uint32_t)(max - min + 1));
+}
+
+static void emitter_flush(struct emitter* emitter)
+{
+    const struct options* options = emitter->options;
+    int64_t duration;
+
+    if (!emitter->pending)
+    {
+        return;
+    }
+
+    duration = (int64_t)(emitter->duration * (1.0 + options->skew / 100.0) + 0.5);
+
+    if (options->jitter > 0)
+    {
+        duration += random_range(-(int32_t)options->jitter, (int32_t)options->jitter);
+    }
+
+    if (duration < 1)
+    {
+        duration = 1;
+    }
+
+    if (options->timestamps)
+    {
+        printf("%u %lld %llu\n", emitter->level, (long long)duration, (unsigned long long)emitter->time);
+    }
+    else
+    {
+        printf("%u %lld\n", emitter->level, (long long)duration);
+    }
+
+    emitter->time += duration;
+    emitter->pending = false;
+}
+
+static void emit(struct emitter* emitter, const bool level, const uint32_t duration)
+{
+    if (emitter->pending && emitter->level == level)
+    {
+        emitter->duration += duration;
+        return;
+    }
+
+    emitter_flush(emitter);
+
+    emitter->pending  = true;
+    emitter->level    = level;
+    emitter->duration = duration;
+}
+
+// idle gap between bursts with short noise pulses spread over it
+static void emit_gap(struct emitter* emitter)
+{
+    const struct options* options = emitter->options;
+    const uint32_t segment = options->gap / (options->noise + 1);
+    unsigned int i;
+
+    for (i = 0; i < options->noise; i++)
+    {
+        emit(emitter, false, segment);
+        emit(emitter, true, random_range(NOISE_MIN_US, NOISE_MAX_US));
+    }
+
+    emit(emitter, false, options->gap - segment * options->noise);
+}
+
+// superheterodyne receivers turn up their gain until noise toggles the output, for -g gap_us in total
+static void emit_idle(struct emitter* emitter)
+{
+    const struct options* options = emitter->options;
+    uint32_t elapsed = 0;
+    uint32_t duration;
+    bool level = false;
+
+    while (elapsed < options->gap)
+    {
+        if (random_next() % 3 != 0)
+        {
+            duration = random_range(IDLE_GLITCH_MIN_US, IDLE_GLITCH_MAX_US);
+        }
+        else
+        {
+            duration = random_range(IDLE_GLITCH_MAX_US, IDLE_LEVEL_MAX_US);
+        }
+
+        emit(emitter, level, duration);
+
+        level = !level;
+        elapsed += duration;
+    }
+}
+
+static bool data_bit(const uint8_t* digits, const unsigned int bit)
+{
+    return (digits[bit / 4] >> (3 - (bit % 4))) & 0x01;
+}
+
+static void emit_portisch_sequence(struct emitter* emitter, const unsigned int index, const PROTOCOL_DATA_UINT8_T* sequence)
+{
+    uint8_t i;
+
+    for (i = 0; i < sequence->size; i++)
+    {
+        const uint8_t entry = sequence->dat[i];
+
+        emit(emitter, (entry & 0x08) != 0, PROTOCOL_DATA[index].buckets.dat[entry & 0x07]);
+    }
+}
+
+static void emit_portisch_frame(struct emitter* emitter, const unsigned int index, const uint8_t* digits, const unsigned int bits, const bool withSync)
+{
+    unsigned int bit;
+
+    if (withSync)
+    {
+        emit_portisch_sequence(emitter, index, &PROTOCOL_DATA[index].start);
+    }
+
+    for (bit = 0; bit < bits; bit++)
+    {
+        emit_portisch_sequence(emitter, index, data_bit(digits, bit) ? &PROTOCOL_DATA[index].bit1 : &PROTOCOL_DATA[index].bit0);
+    }
+
+    emit_portisch_sequence(emitter, index, &PROTOCOL_DATA[index].end);
+}
+
+static void emit_rcswitch_pulse(struct emitter* emitter, const struct Protocol* pro, const struct HighLow* pulse)
+{
+    // inverted protocols start with the low level
+    emit(emitter, !pro->invertedSignal, pulse->high * pro->pulseLength);
+    emit(emitter, pro->invertedSignal, pulse->low * pro->pulseLength);
+}
+
+static void emit_rcswitch_frame(struct emitter* emitter, const struct Protocol* pro, const uint8_t* digits, const unsigned int bits, const bool withSync)
+{
+    unsigned int bit;
+
+    if (withSync)
+    {
+        emit_rcswitch_pulse(emitter, pro, &pro->syncFactor);
+    }
+
+    for (bit = 0; bit < bits; bit++)
+    {
+        emit_rcswitch_pulse(emitter, pro, data_bit(digits, bit) ? &pro->one : &pro->zero);
+    }
+}
+
+static void list_protocols(void)
+{
+    unsigned int i;
+
+    for (i = 0; i < NUM_OF_PROTOCOLS; i++)
+    {
+        printf("portisch:%s\n", portischNames[i]);
+    }
+
+    for (i = 1; i <= numProto; i++)
+    {
+        printf("rcswitch:%u\n", i);
+    }
+}
+
+static int hex_digit(const char c)
+{
+    if (c >= '0' && c <= '9')
+    {
+        return c - '0';
+    }
+
+    if (c >= 'a' && c <= 'f')
+    {
+        return c - 'a' + 10;
+    }
+
+    if (c >= 'A' && c <= 'F')
+    {
+        return c - 'A' + 10;
+    }
+
+    return -1;
+}
+
+static void usage(const char* name)
+{
+    fprintf(stderr,
+        "usage: %s [options] portisch:<name> | rcswitch:<number> | idle\n"
+        "       %s -l\n"
+        "  -l            list protocols\n"
+        "  -d hex        data, most significant bit first (default: random)\n"
+        "  -b bits       number of data bits (default: protocol bit count or 24)\n"
+        "  -r repeats    frames per burst (default: 4)\n"
+        "  -B bursts     number of bursts (default: 1)\n"
+        "  -g gap_us     idle time between bursts, length of the idle trace (default: 100000)\n"
+        "  -n pulses     noise pulses in each gap between bursts (default: 0)\n"
+        "  -j jitter_us  uniform random jitter added to each level (default: 0)\n"
+        "  -k percent    transmitter clock skew, e.g. -3.5 (default: 0)\n"
+        "  -f            drop sync of the first frame in each burst\n"
+        "  -t            write timestamps\n"
+        "  -s seed       random seed (default: 1)\n",
+        name, name);
+    exit(2);
+}
+
+int main(int argc, char** argv)
+{
+    struct options options = { 4, 1, 100000, 0, 0.0, 0, false, false };
+    struct emitter emitter;
+    uint8_t digits[MAX_DATA_DIGITS];
+    unsigned int digitCount = 0;
+    unsigned int bits = 0;
+    unsigned int seed = 1;
+    unsigned int index = 0;
+    unsigned int burst;
+    unsigned int repeat;
+    const char* data = NULL;
+    const char* protocol;
+    bool portisch;
+    bool idle = false;
+    char* end;
+    int opt;
+    int value;
+    unsigned int i;
+
+    while ((opt = getopt(argc, argv, "ld:b:r:B:g:n:j:k:fts:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'l':
+                list_protocols();
+                return 0;
+            case 'd':
+                data = optarg;
+                break;
+            case 'b':
+                bits = strtoul(optarg, NULL, 0);
+                break;
+            case 'r':
+                options.repeats = strtoul(optarg, NULL, 0);
+                break;
+            case 'B':
+                options.bursts = strtoul(optarg, NULL, 0);
+                break;
+            case 'g':
+                options.gap = strtoul(optarg, NULL, 0);
+                break;
+            case 'n':
+                options.noise = strtoul(optarg, NULL, 0);
+                break;
+            case 'j':
+                options.jitter = strtoul(optarg, NULL, 0);
+                break;
+            case 'k':
+                options.skew = strtod(optarg, NULL);
+                break;
+            case 'f':
+                options.dropFirstSync = true;
+                break;
+            case 't':
+                options.timestamps = true;
+                break;
+            case 's':
+                seed = strtoul(optarg, NULL, 0);
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+
+    if (optind + 1 != argc || options.repeats == 0 || options.bursts == 0)
+    {
+        usage(argv[0]);
+    }
+
+    protocol = argv[optind];
+
+    if (strncmp(protocol, "portisch:", 9) == 0)
+    {
+        portisch = true;
+
+        for (index = 0; index < NUM_OF_PROTOCOLS; index++)
+        {
+            if (strcmp(protocol + 9, portischNames[index]) == 0)
+            {
+                break;
+            }
+        }
+
+        if (index == NUM_OF_PROTOCOLS)
+        {
+            fprintf(stderr, "%s: unknown protocol, see -l\n", protocol);
+            return 1;
+        }
+
+        if (bits == 0)
+        {
+            bits = PROTOCOL_DATA[index].bit_count;
+        }
+    }
+    else if (strncmp(protocol, "rcswitch:", 9) == 0)
+    {
+        portisch = false;
+        index = strtoul(protocol + 9, &end, 10);
+
+        if (*end != '\0' || index < 1 || index > numProto)
+        {
+            fprintf(stderr, "%s: unknown protocol, see -l\n", protocol);
+            return 1;
+        }
+
+        if (bits == 0)
+        {
+            bits = data ? strlen(data) * 4 : 24;
+        }
+    }
+    else if (strcmp(protocol, "idle") == 0)
+    {
+        portisch = false;
+        idle = true;
+    }
+    else
+    {
+        usage(argv[0]);
+    }
+
+    randomState = seed ? seed : 1;
+
+    // receiver noise only, no data
+    if (idle)
+    {
+        printf("# generated by tracegen:");
+
+        for (i = 1; i < (unsigned int)argc; i++)
+        {
+            printf(" %s", argv[i]);
+        }
+
+        printf("\n# receiver noise without a transmitter\n");
+
+        memset(&emitter, 0, sizeof(emitter));
+        emitter.options = &options;
+
+        emit_idle(&emitter);
+        emitter_flush(&emitter);
+
+        return 0;
+    }
+
+    if (data != NULL)
+    {
+        for (digitCount = 0; data[digitCount] != '\0'; digitCount++)
+        {
+            value = hex_digit(data[digitCount]);
+
+            if (value < 0 || digitCount == MAX_DATA_DIGITS)
+            {
+                fprintf(stderr, "%s: expected at most %u hex digits\n", data, MAX_DATA_DIGITS);
+                return 1;
+            }
+
+            digits[digitCount] = value;
+        }
+    }
+    else
+    {
+        digitCount = (bits + 3) / 4;
+
+        if (digitCount > MAX_DATA_DIGITS)
+        {
+            fprintf(stderr, "%u bits: at most %u bits of random data\n", bits, MAX_DATA_DIGITS * 4);
+            return 1;
+        }
+
+        for (i = 0; i < digitCount; i++)
+        {
+            digits[i] = random_next() & 0x0F;
+        }
+    }
+
+    if (bits == 0 || bits > digitCount * 4)
+    {
+        fprintf(stderr, "%u bits: data has %u bits\n", bits, digitCount * 4);
+        return 1;
+    }
+
+    printf("# generated by tracegen:");
+
+    for (i = 1; i < (unsigned int)argc; i++)
+    {
+        printf(" %s", argv[i]);
+    }
+
+    printf("\n# %u bits data ", bits);
+
+    for (i = 0; i < digitCount; i++)
+    {
+        printf("%X", digits[i]);
+    }
+
+    printf("\n");
+
+    memset(&emitter, 0, sizeof(emitter));
+    emitter.options = &options;
+
+    for (burst = 0; burst < options.bursts; burst++)
+    {
+        if (burst > 0)
+        {
+            emit_gap(&emitter);
+        }
+
+        for (repeat = 0; repeat < options.repeats; repeat++)
+        {
+            const bool withSync = !(options.dropFirstSync && repeat == 0);
+
+            if (portisch)
+            {
+                emit_portisch_frame(&emitter, index, digits, bits, withSync);
+            }
+            else
+            {
+                emit_rcswitch_frame(&emitter, &protocols[index - 1], digits, bits, withSync);
+            }
+        }
+
+        // rcswitch decodes a frame once the following sync arrives
+        if (!portisch)
+        {
+            emit_rcswitch_pulse(&emitter, &protocols[index - 1], &protocols[index - 1].syncFactor);
+        }
+    }
+
+    emitter_flush(&emitter);
+
+    return 0;
+}
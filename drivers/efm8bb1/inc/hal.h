@@ -111,6 +111,36 @@ inline bool uart_rx_pin_level(void)
     return UART_RX_PIN;
 }
 
+// passthrough copies the receiver level to the uart tx pin from the capture interrupt (see main_passthrough.c)
+// a branch does not go through the carry flag, which the interrupt would have to save first
+inline void mirror_rdata_to_uart_tx(void)
+{
+    if (RDATA)
+    {
+        UART_TX_PIN = 1;
+    } else {
+        UART_TX_PIN = 0;
+    }
+}
+
+// hybrid images copy the receiver level to MIRROR_PIN from the capture interrupt (see rdata_mirror.h)
+inline void mirror_rdata_to_mirror_pin(void)
+{
+    if (RDATA)
+    {
+        MIRROR_PIN = 1;
+    } else {
+        MIRROR_PIN = 0;
+    }
+}
+
+// single instruction, so interrupts can clear it without a call
+inline void clear_capture_flag(void)
+{
+    //PCA0CN0 &= ~CF__SET;
+    CCF0 = 0;
+}
+
 inline void uart_rx_enabled(void)
 {
     // uart reception enabled
@@ -289,13 +319,12 @@ extern void enable_serial_interrupt(void);
 extern void disable_serial_interrupt(void);
 
 extern bool is_global_interrupt_enabled(void);
+extern bool is_serial_interrupt_enabled(void);
 
 
 extern unsigned char get_timer2_low(void);
 extern unsigned char get_timer2_high(void);
 
-extern void clear_capture_flag(void);
-
 extern unsigned long countsToTime(const unsigned long duration);
 
 #endif // INC_HAL_H_
@@ -34,6 +34,10 @@
 //
 #define TIMER2_RELOAD_1MILLIS   0xF805
 
+// free running tick from timer 0 overflows, 16 bit timer on system clock / 12 (see init_tick_timer())
+#define TICK_CLOCKS (65536UL * 12)
+#define MS_TO_TICK_COUNT(ms) ((uint16_t)(((uint32_t)(ms) * (MCU_FREQ / 1000UL) + TICK_CLOCKS / 2) / TICK_CLOCKS))
+
 //unsigned long get_time_milliseconds(void);
 //unsigned long get_time_ten_microseconds(void);
 
@@ -43,7 +47,11 @@ void wait_delay_timer_finished(void);
 void stop_delay_timer(void);
 bool is_delay_timer_finished(void);
 
+void init_tick_timer(void);
+uint16_t get_tick_count(void);
+
 void clear_interrupt_flags_pca(void);
 void clear_pca_counter(void);
+void enable_capture_overflow_interrupt(void);
 
 #endif
\ No newline at end of file
@@ -9,6 +9,15 @@
 
 #include <EFM8BB1.h>
 
+#include "capture_ticks.h"
+#include "capture_timer.h"
+#include "rdata_mirror.h"
+
+// pca0 runs on sysclk/12, sysclk/4 or sysclk (CPS), see CAPTURE_PRESCALER in the makefile
+#if CAPTURE_PRESCALER != 12 && CAPTURE_PRESCALER != 4 && CAPTURE_PRESCALER != 1
+    #error CAPTURE_PRESCALER must be 12, 4 or 1 on EFM8BB1
+#endif
+
 
 void set_clock_mode(void)
 {
@@ -92,9 +101,12 @@ void init_port_pins_for_passthrough(void)
     //P1_3 = 1;
 
     // default is not skipped (i.e. available to crossbar)
-    // but we will skip all to use as gpio
+    // but we will skip all to use as gpio, except radio receive for the capture interrupt that mirrors it
     P0SKIP = 0xFF;
-    P1SKIP = 0xFF;
+    P1SKIP = B0__SKIPPED | B1__SKIPPED | B2__SKIPPED | B3__NOT_SKIPPED | B4__SKIPPED | B5__SKIPPED | B6__SKIPPED | B7__SKIPPED;
+    
+    // CEX0 routed to port pin (first pin not skipped, because uart is not routed)
+    XBR1 |= PCA0ME__CEX0;
     
     // FIXME: why do the examples set this when it is the default?
     // default is weak pullups enabled (makes sure input pins always have a known state even if externally disconnected) 
@@ -125,6 +137,11 @@ void init_port_pins_for_serial(void)
     P0SKIP = B0__SKIPPED | B1__SKIPPED | B2__SKIPPED | B3__SKIPPED     | B4__NOT_SKIPPED | B5__NOT_SKIPPED | B6__SKIPPED | B7__SKIPPED;
     P1SKIP = B0__SKIPPED | B1__SKIPPED | B2__SKIPPED | B3__NOT_SKIPPED | B4__SKIPPED     | B5__SKIPPED     | B6__SKIPPED | B7__SKIPPED;
     
+#if RDATA_MIRROR == 1 && defined(TARGET_BOARD_EFM8BB1)
+    // copy of radio receive on P2.0 (see sonoffr20_pins.h), P1.5 of the development board is push pull already
+    P2MDOUT |= B0__PUSH_PULL;
+#endif
+    
     // UART TX, RX routed to Port pins P0.4 and P0.5
     XBR0 |= URT0E__ENABLED;
     
@@ -172,7 +189,10 @@ void enable_capture_interrupt(void)
 void disable_capture_interrupt(void)
 {
     PCA0CPM0 &= ~ECCF__ENABLED;
+    // counter overflows of the free-running counter still have to be counted
+#if CAPTURE_FREE_RUNNING == 0
     EIE1     &= ~EPCA0__ENABLED;
+#endif
 }
 
 // FIXME: it is inconsistent to set 16-bit value for timer0 and 8-bit value for timer1
@@ -223,6 +243,11 @@ void pca0_init(void)
     // default source is system clock divided by 12
     // default pca CF overflow is disabled
     //PCA0MD &= ~CPS__SYSCLK_DIV_12;
+#if CAPTURE_PRESCALER == 4
+    PCA0MD = (PCA0MD & ~CPS__FMASK) | CPS__SYSCLK_DIV_4;
+#elif CAPTURE_PRESCALER == 1
+    PCA0MD = (PCA0MD & ~CPS__FMASK) | CPS__SYSCLK;
+#endif
     
     // enable both positive and negative edge triggers
     PCA0CPM0 |= CAPP__ENABLED;
@@ -245,6 +270,11 @@ bool is_global_interrupt_enabled(void)
     return EA;
 }
 
+bool is_serial_interrupt_enabled(void)
+{
+    return ES0;
+}
+
 unsigned char get_timer2_low(void)
 {
     return TMR2L;
@@ -255,19 +285,17 @@ unsigned char get_timer2_high(void)
     return TMR2H;
 }
 
-void clear_capture_flag(void)
-{
-    //PCA0CN0 &= ~CF__SET;
-    CCF0 = 0;
-}
-
 // the time constant is explained in the rcswitch.c file
 
 unsigned long countsToTime(const unsigned long duration)
 {
     unsigned long converted;
     
+#if CAPTURE_PRESCALER == 12
     converted = duration / 2;
+#else
+    converted = CAPTURE_COUNTS_TO_US(duration);
+#endif
     
     return converted;
 }
\ No newline at end of file
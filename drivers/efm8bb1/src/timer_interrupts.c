@@ -15,6 +15,9 @@
 //    #error Please define TARGET_BOARD in makefile
 //#endif
 
+#include "capture_gate.h"
+#include "capture_timer.h"
+#include "rdata_mirror.h"
 #include "timer_interrupts.h"
 
 // track time since startup in one millisecond increments
@@ -23,6 +26,11 @@
 
 static __xdata uint16_t gTimer2Timeout;
 
+#if PORTISCH_DEDUP_CACHE_SIZE > 0
+// timer 0 overflows since init_tick_timer()
+static __xdata volatile uint16_t gTickCount = 0;
+#endif
+
 //unsigned long get_time_milliseconds(void)
 //{
 //  return gTimeMilliseconds;
@@ -43,6 +51,8 @@ void clear_interrupt_flags_pca(void)
 
 void clear_pca_counter(void)
 {
+    // a free-running counter keeps counting, durations are differences then (see capture_timer.h)
+#if CAPTURE_FREE_RUNNING == 0
     // FIXME: I think this was a bug in portisch
 	//uint8_t flags = PCA0MD;
     uint8_t flags = PCA0CN0;
@@ -63,7 +73,17 @@ void clear_pca_counter(void)
     // FIXME: why not just explicitly set CR bit if that was the intent?
     //PCA0MD = flags;
     PCA0CN0 = flags;
+#endif
+}
+
+#if CAPTURE_FREE_RUNNING == 1
+// only the decoder images count overflows of the free-running counter, see capture_timer.h
+void enable_capture_overflow_interrupt(void)
+{
+    // CF shares the pca interrupt with the captures
+    PCA0MD |= ECF__ENABLED;
 }
+#endif
 
 // Portisch favored this approach to timer delay
 void set_timer2_reload(const uint16_t reload)
@@ -134,6 +154,41 @@ bool is_delay_timer_finished(void)
     return !TR2;
 }
 
+// only the portisch dedup cache needs the tick, so flash is not spent on it otherwise
+#if PORTISCH_DEDUP_CACHE_SIZE > 0
+// unlike the delay timer this keeps running, so elapsed time can be measured while transmitting
+void init_tick_timer(void)
+{
+    // 16-bit mode, clocked by the default prescaler of system clock / 12, overflows every 32 ms at 24.5 MHz
+    TMOD = (TMOD & 0xF0) | T0M__MODE1;
+    
+    TH0 = 0x00;
+    TL0 = 0x00;
+    
+    enable_timer0_interrupt();
+    timer0_run();
+}
+
+uint16_t get_tick_count(void)
+{
+    uint16_t ticks;
+    
+    // an overflow while the interrupt is disabled stays pending, so no count is missed
+    disable_timer0_interrupt();
+    ticks = gTickCount;
+    enable_timer0_interrupt();
+    
+    return ticks;
+}
+
+// timer 0 interrupt
+void timer0_isr(void) __interrupt (TIMER0_VECTOR)
+{
+    // flag is cleared by hardware when vectoring to the interrupt
+    gTickCount++;
+}
+#endif
+
 // timer 2 interrupt
 void timer2_isr(void) __interrupt (TIMER2_VECTOR)
 {
@@ -156,21 +211,49 @@ void pca0_isr(void) __interrupt (PCA0_VECTOR)
     //FIXME: we need to record the actual time step this represents so it is clear to human readers
     //FIXME: should be PCA0CP0 * 10 for Portisch?
     //       probably not, because we are using dedicated PCA counter instead of timer 0 as portisch did originally
-    uint16_t currentCapture = PCA0CP0;
+    uint16_t currentCapture;
+    uint8_t flags;
+    
+    // hybrid images, first so that the copy follows the edge closely
+    MIRROR_RDATA();
+    
+    currentCapture = PCA0CP0;
     
     // save and clear flags
-    uint8_t flags = PCA0CN0 & (CF__BMASK | CCF0__BMASK | CCF1__BMASK | CCF2__BMASK);
+    flags = PCA0CN0 & (CF__BMASK | CCF0__BMASK | CCF1__BMASK | CCF2__BMASK);
 
     // clear
     PCA0CN0 &= ~flags;
 
-    // FIXME: we might eventually want to use CF flag to detect counter wrap around
+    // counter wrap around (CF) is only enabled for the free-running counter, see capture_timer.h
     if((flags & CCF0__BMASK) && (PCA0CPM0 & ECCF__BMASK))
     {
         // apparently our radio input
         //pca0_channel0EventCb();
+#if CAPTURE_FREE_RUNNING == 1
+        currentCapture = capture_duration(currentCapture, flags & CF__BMASK);
+#endif
+        
+        // during noise storms most edges only restart the counter, see capture_gate.h
+#if CAPTURE_STORM_GATE == 1
+        if (capture_gate(currentCapture))
+        {
+            capture_handler(currentCapture);
+        }
+        else
+        {
+            clear_pca_counter();
+        }
+#else
         capture_handler(currentCapture);
+#endif
+    }
+#if CAPTURE_FREE_RUNNING == 1
+    else if (flags & CF__BMASK)
+    {
+        capture_timer_overflow();
     }
+#endif
     
     // done in the interrupt already on efm8bb1
     // but must be explicitly cleared on ob38s003
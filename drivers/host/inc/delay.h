@@ -0,0 +1,9 @@
+#ifndef _DELAY_H
+#define _DELAY_H
+
+#include <stdint.h>
+
+void delay_us(uint8_t us);
+void delay1ms(const uint16_t msCount);
+
+#endif // _DELAY_H
@@ -0,0 +1,103 @@
+/*
+ * hal.h - Hardware abstraction layer stub for host (native) builds
+ *
+ *  There is no hardware here, so pin writes are dropped and pin reads and time
+ *  come from whatever the host program (e.g., bench/portisch_replay.c) set.
+ */
+
+#ifndef INC_HAL_H_
+#define INC_HAL_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "capture_ticks.h"
+
+// state shared with the host program driving the firmware sources
+extern bool host_rdata;
+extern bool host_led;
+extern bool host_tdata;
+
+// simulated time since start in microseconds
+extern uint32_t host_time_us;
+
+// one count is one microsecond at the default host clock, see host_compat.h
+static inline unsigned long countsToTime(const unsigned long duration)
+{
+    return CAPTURE_COUNTS_TO_US(duration);
+}
+
+static inline bool rdata_level(void)
+{
+    return host_rdata;
+}
+
+static inline void led_on(void)
+{
+    host_led = true;
+}
+
+static inline void led_off(void)
+{
+    host_led = false;
+}
+
+static inline void set_led(const bool state)
+{
+    host_led = state;
+}
+
+static inline void led_toggle(void)
+{
+    host_led = !host_led;
+}
+
+static inline void buzzer_on(void)
+{
+}
+
+static inline void buzzer_off(void)
+{
+}
+
+static inline void tdata_on(void)
+{
+    host_tdata = true;
+}
+
+static inline void tdata_off(void)
+{
+    host_tdata = false;
+}
+
+static inline void set_tdata(const bool state)
+{
+    host_tdata = state;
+}
+
+static inline void radio_receiver_on(void)
+{
+}
+
+static inline void radio_receiver_off(void)
+{
+}
+
+static inline void enable_global_interrupts(void)
+{
+}
+
+static inline void disable_global_interrupts(void)
+{
+}
+
+extern void enable_capture_interrupt(void);
+extern void disable_capture_interrupt(void);
+
+extern void pca0_run(void);
+extern void pca0_halt(void);
+
+// host only
+extern void host_advance_us(const uint32_t us);
+
+#endif // INC_HAL_H_
@@ -0,0 +1,32 @@
+/*
+ * host_compat.h - lets sdcc/8051 sources compile with a native compiler
+ *
+ *  Force included (gcc -include) by the host build in the Makefile.
+ */
+
+#ifndef INC_HOST_COMPAT_H_
+#define INC_HOST_COMPAT_H_
+
+// sdcc memory space qualifiers have no meaning on a host, everything is just ram
+#define __data
+#define __idata
+#define __pdata
+#define __xdata
+#define __code
+
+// sdcc function attributes
+#define __interrupt(x)
+#define __using(x)
+#define __critical
+#define __reentrant
+
+// capture counter of the host builds runs at 1 MHz unless a board is emulated (see HOST_TICKS_FLAGS in the makefile)
+#ifndef MCU_FREQ
+#define MCU_FREQ 1000000UL
+#endif
+
+#ifndef CAPTURE_PRESCALER
+#define CAPTURE_PRESCALER 1
+#endif
+
+#endif // INC_HOST_COMPAT_H_
@@ -0,0 +1,26 @@
+/*
+ * timer_interrupts.h - delay timer stub for host (native) builds
+ */
+
+#ifndef INC_TIMER_INTERRUPT_H_
+#define INC_TIMER_INTERRUPT_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+void init_delay_timer_us(const uint16_t interval, const uint16_t timeout);
+void init_delay_timer_ms(const uint16_t interval, const uint16_t timeout);
+void wait_delay_timer_finished(void);
+void stop_delay_timer(void);
+bool is_delay_timer_finished(void);
+
+// free running tick counts simulated milliseconds
+#define MS_TO_TICK_COUNT(ms) ((uint16_t)(ms))
+
+void init_tick_timer(void);
+uint16_t get_tick_count(void);
+
+void clear_interrupt_flags_pca(void);
+void clear_pca_counter(void);
+
+#endif
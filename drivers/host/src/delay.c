@@ -0,0 +1,16 @@
+/*
+ * delay.c - busy wait delays just move simulated time forward on host
+ */
+
+#include "delay.h"
+#include "hal.h"
+
+void delay_us(uint8_t us)
+{
+    host_advance_us(us);
+}
+
+void delay1ms(const uint16_t msCount)
+{
+    host_advance_us((uint32_t)msCount * 1000);
+}
@@ -0,0 +1,39 @@
+/*
+ * hal.c - Hardware abstraction layer stub for host (native) builds
+ */
+
+#include "hal.h"
+
+bool host_rdata = false;
+bool host_led   = false;
+bool host_tdata = false;
+
+uint32_t host_time_us = 0;
+
+static bool capture_enabled = false;
+static bool capture_running = false;
+
+void host_advance_us(const uint32_t us)
+{
+    host_time_us += us;
+}
+
+void enable_capture_interrupt(void)
+{
+    capture_enabled = true;
+}
+
+void disable_capture_interrupt(void)
+{
+    capture_enabled = false;
+}
+
+void pca0_run(void)
+{
+    capture_running = true;
+}
+
+void pca0_halt(void)
+{
+    capture_running = false;
+}
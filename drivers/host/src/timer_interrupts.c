@@ -0,0 +1,71 @@
+/*
+ * timer_interrupts.c - delay timer stub for host (native) builds
+ *
+ *  The on demand delay timer is modeled as a deadline in simulated time,
+ *  so crc debounce in the decoders behaves as it would on the bridge.
+ */
+
+#include "hal.h"
+#include "timer_interrupts.h"
+
+static bool     gTimerRunning = false;
+static uint32_t gTimerDeadline;
+
+static void start_delay_timer(const uint32_t us)
+{
+    gTimerDeadline = host_time_us + us;
+    gTimerRunning  = true;
+}
+
+// timeout is in ten microsecond steps, same as the firmware drivers
+void init_delay_timer_us(const uint16_t interval, const uint16_t timeout)
+{
+    start_delay_timer((uint32_t)timeout * 10);
+}
+
+void init_delay_timer_ms(const uint16_t interval, const uint16_t timeout)
+{
+    start_delay_timer((uint32_t)timeout * 1000);
+}
+
+void wait_delay_timer_finished(void)
+{
+    if (gTimerRunning && (int32_t)(gTimerDeadline - host_time_us) > 0)
+    {
+        host_time_us = gTimerDeadline;
+    }
+
+    gTimerRunning = false;
+}
+
+void stop_delay_timer(void)
+{
+    gTimerRunning = false;
+}
+
+bool is_delay_timer_finished(void)
+{
+    if (gTimerRunning && (int32_t)(gTimerDeadline - host_time_us) <= 0)
+    {
+        gTimerRunning = false;
+    }
+
+    return !gTimerRunning;
+}
+
+void init_tick_timer(void)
+{
+}
+
+uint16_t get_tick_count(void)
+{
+    return (uint16_t)(host_time_us / 1000);
+}
+
+void clear_interrupt_flags_pca(void)
+{
+}
+
+void clear_pca_counter(void)
+{
+}
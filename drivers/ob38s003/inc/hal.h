@@ -165,6 +165,42 @@ inline bool uart_rx_pin_level(void)
     return UART_RX_PIN;
 }
 
+// passthrough copies the receiver level to the uart tx pin from the capture interrupt (see main_passthrough.c)
+// a branch does not go through the carry flag, which the interrupt would have to save first
+inline void mirror_rdata_to_uart_tx(void)
+{
+    if (RDATA)
+    {
+        UART_TX_PIN = 1;
+    } else {
+        UART_TX_PIN = 0;
+    }
+}
+
+// hybrid images copy the receiver level to MIRROR_PIN from the capture interrupt (see rdata_mirror.h)
+inline void mirror_rdata_to_mirror_pin(void)
+{
+    if (RDATA)
+    {
+        MIRROR_PIN = 1;
+    } else {
+        MIRROR_PIN = 0;
+    }
+}
+
+// single instruction, so interrupts can clear it without a call
+inline void clear_capture_flag(void)
+{
+    // clear CCF1 bit
+    CCCON &= ~0x02;
+}
+
+// CCF1 set with its interrupt enabled, the timer 2 overflow (TF2) shares the interrupt
+inline bool is_capture_pending(void)
+{
+    return (CCCON & 0x22) == 0x22;
+}
+
 inline void uart_rx_enabled(void)
 {
     // uart reception enabled
@@ -253,12 +289,11 @@ void pca0_run(void);
 void pca0_halt(void);
 
 extern bool is_global_interrupt_enabled(void);
+extern bool is_serial_interrupt_enabled(void);
 
 void load_timer0(const uint16_t load);
 extern uint16_t get_capture_mode(void);
 
-extern void clear_capture_flag(void);
-
 extern unsigned long countsToTime(const unsigned long duration);
 
 
@@ -4,8 +4,15 @@
  *      Author: Jonathan Armstrong
  */
 
+#include "capture_ticks.h"
 #include "hal.h"
 #include "OB38S003.h"
+#include "rdata_mirror.h"
+
+// timer 2 runs on fosc/24 or fosc/12 (T2PS), see CAPTURE_PRESCALER in the makefile
+#if CAPTURE_PRESCALER != 24 && CAPTURE_PRESCALER != 12
+    #error CAPTURE_PRESCALER must be 24 or 12 on OB38S003
+#endif
 
 
 // pg. 3 of OB38S003 datasheet
@@ -84,6 +91,12 @@ void init_port_pins(void)
     //P1M1 &= ~0x20;
     //P1M0 &= ~0x20;
     
+#if RDATA_MIRROR == 1
+    // copy of radio incoming push pull, on the reset pin (see sonoffr22_pins.h)
+    P1M1 &= ~0x20;
+    P1M0 |=  0x20;
+#endif
+    
     // rf sleep/wake push pull
     // see sonoffr22_pins.h - pin attached to upper leg of resistor divider
     P1M1 &= ~0x80;
@@ -201,7 +214,12 @@ void init_timer2_as_capture(void)
     // timer 2 mode 0 auto reload (generated by a timer 2 overflow)
     // timer 2 is clocked with 1/24 of the oscillator frequency (prescaler select bit)
     // (e.g., 0.25 microseconds per count)
+    // or 1/12 for twice the resolution and half the range
+#if CAPTURE_PRESCALER == 24
     T2CON = 0xC1;
+#else
+    T2CON = 0x41;
+#endif
 }
 
 // FIXME: this is not really called the PCA on this microcontroller
@@ -225,6 +243,11 @@ bool is_global_interrupt_enabled(void)
     return EA;
 }
 
+bool is_serial_interrupt_enabled(void)
+{
+    return ES;
+}
+
 
 uint16_t get_capture_mode(void)
 {
@@ -232,12 +255,6 @@ uint16_t get_capture_mode(void)
     return (CCH1 << 8) | CCL1;
 }
 
-void clear_capture_flag(void)
-{
-    // clear CCF1 bit
-    CCCON &= ~0x02;
-}
-
 unsigned char get_stack_pointer(void)
 {
     return SP;
@@ -248,7 +265,11 @@ unsigned long countsToTime(const unsigned long duration)
 {
     unsigned long converted;
     
+#if CAPTURE_PRESCALER == 24
     converted = (duration * 3) / 2;
+#else
+    converted = CAPTURE_COUNTS_TO_US(duration);
+#endif
     
     return converted;
 }
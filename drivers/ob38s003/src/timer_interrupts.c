@@ -15,6 +15,9 @@
 //    #error Please define TARGET_BOARD in makefile
 //#endif
 
+#include "capture_gate.h"
+#include "capture_timer.h"
+#include "rdata_mirror.h"
 #include "timer_interrupts.h"
 
 // track time since startup in one millisecond increments
@@ -23,6 +26,11 @@
 
 static __xdata uint16_t gTimer1Timeout;
 
+#if PORTISCH_DEDUP_CACHE_SIZE > 0
+// timer 0 overflows since init_tick_timer()
+static __xdata volatile uint16_t gTickCount = 0;
+#endif
+
 //uint16_t get_time_milliseconds(void)
 //{
 //  return gTimeMilliseconds;
@@ -43,6 +51,8 @@ void clear_interrupt_flags_pca(void)
 
 void clear_pca_counter(void)
 {
+    // a free-running timer keeps counting, durations are differences then (see capture_timer.h)
+#if CAPTURE_FREE_RUNNING == 0
 	//uint8_t flags = PCA0MD;
     
     // timer 2 stop
@@ -56,7 +66,17 @@ void clear_pca_counter(void)
 	
     // start timer2, input frequency from prescaler
     T2CON |= 0x01;
+#endif
+}
+
+#if CAPTURE_FREE_RUNNING == 1
+// only the decoder images count overflows of the free-running counter, see capture_timer.h
+void enable_capture_overflow_interrupt(void)
+{
+    // TF2 shares the timer 2 interrupt with the captures
+    enable_timer2_interrupt();
 }
+#endif
 
 // appears that a tick implementation that increments a counter
 // is difficult to obtain accurate timings for on this processor
@@ -127,6 +147,44 @@ bool is_delay_timer_finished(void)
     return !TR1;
 }
 
+// only the portisch dedup cache needs the tick, so flash is not spent on it otherwise
+#if PORTISCH_DEDUP_CACHE_SIZE > 0
+// unlike the delay timer this keeps running, so elapsed time can be measured while transmitting
+void init_tick_timer(void)
+{
+    // 16-bit mode
+    TMOD = (TMOD & 0xF0) | 0x01;
+    
+    // T0PS prescaler Fosc/12, overflows every 49 ms at 16 MHz
+    PFCON &= ~0x03;
+    
+    TH0 = 0x00;
+    TL0 = 0x00;
+    
+    enable_timer0_interrupt();
+    timer0_run();
+}
+
+uint16_t get_tick_count(void)
+{
+    uint16_t ticks;
+    
+    // an overflow while the interrupt is disabled stays pending, so no count is missed
+    disable_timer0_interrupt();
+    ticks = gTickCount;
+    enable_timer0_interrupt();
+    
+    return ticks;
+}
+
+// timer 0 interrupt
+void timer0_isr(void) __interrupt (d_T0_Vector)
+{
+    // flag is cleared by hardware when vectoring to the interrupt
+    gTickCount++;
+}
+#endif
+
 #if 0
 
 void timer0_isr(void) __interrupt (d_T0_Vector)
@@ -170,9 +228,53 @@ void timer1_isr(void) __interrupt (d_T1_Vector)
 //-----------------------------------------------------------------------------
 void timer2_isr(void) __interrupt (d_T2_Vector)
 {
-    uint16_t currentCapture = get_capture_mode();
+    uint16_t currentCapture;
+#if CAPTURE_FREE_RUNNING == 1
+    bool overflowed;
+#endif
+    
+    // hybrid images, first so that the copy follows the edge closely
+    MIRROR_RDATA();
+    
+    currentCapture = get_capture_mode();
+    
+#if CAPTURE_FREE_RUNNING == 1
+    // the timer 2 overflow shares this interrupt, see capture_timer.h
+    // (only cleared when set, so an overflow right after reading the flag is not lost)
+    overflowed = TF2;
+    
+    if (overflowed)
+    {
+        TF2 = 0;
+    }
     
+    if (!is_capture_pending())
+    {
+        if (overflowed)
+        {
+            capture_timer_overflow();
+        }
+        
+        clear_capture_flag();
+        return;
+    }
+    
+    currentCapture = capture_duration(currentCapture, overflowed);
+#endif
+    
+    // during noise storms most edges only restart the counter, see capture_gate.h
+#if CAPTURE_STORM_GATE == 1
+    if (capture_gate(currentCapture))
+    {
+        capture_handler(currentCapture);
+    }
+    else
+    {
+        clear_pca_counter();
+    }
+#else
     capture_handler(currentCapture);
+#endif
     
     // done in the interrupt already on efm8bb1
     // but must be explicitly cleared on ob38s003
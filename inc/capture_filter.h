@@ -0,0 +1,100 @@
+/*
+ * capture_filter.h - optional glitch filter with adaptive noise floor in front of the decoders
+ *
+ *  Superheterodyne receivers turn up their gain when no transmitter is present,
+ *  so the output keeps toggling on noise, mostly as very short pulses.
+ *  Building with CAPTURE_GLITCH_FILTER=1 (GLITCH=1 in the makefile) merges a pulse shorter
+ *  than the glitch threshold, together with the duration after it, into the duration before it.
+ *  Decoders then only see levels of useful length which still alternate between high and low.
+ *  Each duration is held back until the next edge shows that no glitch followed it.
+ *
+ *  The threshold is a noise floor which follows the edge rate: after every
+ *  CAPTURE_NOISE_WINDOW_EDGES edges it is raised one step if they came faster than
+ *  CAPTURE_NOISE_RATE_HIGH edges per second and lowered one step if slower than
+ *  CAPTURE_NOISE_RATE_LOW, between CAPTURE_GLITCH_MIN_US and CAPTURE_GLITCH_MAX_US.
+ *  The maximum stays below the shortest pulse the decoders accept (MIN_BUCKET_LENGTH,
+ *  100 us pulses of rcswitch protocol 3), so transmissions which raise the rate are not harmed.
+ *  The rate is taken from the captured durations themselves, so no timer is needed.
+ *
+ *  Works on capture counts, before conversion to microseconds.
+ *  With CAPTURE_GLITCH_FILTER=0 the filter and its variables are compiled out.
+ */
+
+#ifndef INC_CAPTURE_FILTER_H_
+#define INC_CAPTURE_FILTER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "capture_ticks.h"
+#include "rf_stats.h"
+
+#ifndef CAPTURE_GLITCH_FILTER
+#define CAPTURE_GLITCH_FILTER 0
+#endif
+
+// range of the glitch threshold in microseconds
+#ifndef CAPTURE_GLITCH_MIN_US
+#define CAPTURE_GLITCH_MIN_US 16
+#endif
+
+#ifndef CAPTURE_GLITCH_MAX_US
+#define CAPTURE_GLITCH_MAX_US 64
+#endif
+
+// steps from minimum to maximum threshold
+#ifndef CAPTURE_GLITCH_STEPS
+#define CAPTURE_GLITCH_STEPS 4
+#endif
+
+// edges per noise floor update and the edge rates (edges per second) which move the threshold
+#ifndef CAPTURE_NOISE_WINDOW_EDGES
+#define CAPTURE_NOISE_WINDOW_EDGES 32
+#endif
+
+#ifndef CAPTURE_NOISE_RATE_HIGH
+#define CAPTURE_NOISE_RATE_HIGH 4000
+#endif
+
+#ifndef CAPTURE_NOISE_RATE_LOW
+#define CAPTURE_NOISE_RATE_LOW 1000
+#endif
+
+#define CAPTURE_GLITCH_MIN_COUNTS  US_TO_CAPTURE_COUNTS(CAPTURE_GLITCH_MIN_US)
+#define CAPTURE_GLITCH_MAX_COUNTS  US_TO_CAPTURE_COUNTS(CAPTURE_GLITCH_MAX_US)
+#define CAPTURE_GLITCH_STEP_COUNTS ((CAPTURE_GLITCH_MAX_COUNTS - CAPTURE_GLITCH_MIN_COUNTS) / CAPTURE_GLITCH_STEPS)
+
+// total time of one window at the high and low edge rate
+#define CAPTURE_NOISE_FAST_COUNTS US_TO_CAPTURE_COUNTS(1000000UL * CAPTURE_NOISE_WINDOW_EDGES / CAPTURE_NOISE_RATE_HIGH)
+#define CAPTURE_NOISE_SLOW_COUNTS US_TO_CAPTURE_COUNTS(1000000UL * CAPTURE_NOISE_WINDOW_EDGES / CAPTURE_NOISE_RATE_LOW)
+
+#if CAPTURE_GLITCH_FILTER == 1
+
+// same as CAPTURE_NOISE_SLOW_COUNTS without the cast, which the preprocessor can not evaluate
+#if (1000000UL * CAPTURE_NOISE_WINDOW_EDGES / CAPTURE_NOISE_RATE_LOW) * (MCU_FREQ / 1000UL) / (CAPTURE_PRESCALER * 1000UL) >= 0xFFFF
+#error "CAPTURE_NOISE_WINDOW_EDGES / CAPTURE_NOISE_RATE_LOW must fit into 16 bit capture counts"
+#endif
+
+#if CAPTURE_NOISE_WINDOW_EDGES > 255
+#error "CAPTURE_NOISE_WINDOW_EDGES must fit into 8 bit"
+#endif
+
+// duration released by capture_filter() and its level (true for high), valid after it returned true
+extern __xdata uint16_t capture_filter_counts;
+extern __xdata bool capture_filter_level;
+
+// current glitch threshold (noise floor) in capture counts
+extern __xdata uint16_t capture_glitch_counts;
+
+#if RF_STATS == 1
+// glitches merged into their neighbours
+extern __xdata uint16_t capture_glitches;
+#endif
+
+// called by capture_handler() with the duration which just ended,
+// returns true if an earlier duration is passed on in capture_filter_counts
+extern bool capture_filter(const uint16_t counts, const bool level);
+
+#endif // CAPTURE_GLITCH_FILTER == 1
+
+#endif // INC_CAPTURE_FILTER_H_
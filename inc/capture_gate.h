@@ -0,0 +1,83 @@
+/*
+ * capture_gate.h - optional load shedding of the capture interrupt during receiver noise storms
+ *
+ *  Without a transmitter the AGC of the receiver turns noise into thousands of edges per second.
+ *  Each edge runs capture_handler(), with its conversion to microseconds and the decoder work behind it.
+ *  Building with CAPTURE_STORM_GATE=1 (STORM_GATE=1 in the makefile) lets the capture interrupt
+ *  watch the edges through capture_gate(). A storm is CAPTURE_STORM_WINDOW_EDGES edges arriving
+ *  faster than CAPTURE_STORM_RATE edges per second with at least CAPTURE_STORM_SHORT_EDGES of them
+ *  shorter than CAPTURE_STORM_SHORT_US, which frames do not have. Then the gate closes.
+ *  While it is closed the interrupt only compares the capture counts and restarts the counter.
+ *  A duration of at least capture_gate_counts could be the sync of a frame, so it is passed on
+ *  and full capture resumes with it.
+ *  The storm consists of short durations, which already reset the decoders before the gate closed.
+ *
+ *  The decoder sets capture_gate_counts to the shortest sync it can start a frame with,
+ *  until then (0) the gate stays open.
+ *  With CAPTURE_STORM_GATE=0 the gate and its variables are compiled out.
+ */
+
+#ifndef INC_CAPTURE_GATE_H_
+#define INC_CAPTURE_GATE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "capture_ticks.h"
+#include "rf_stats.h"
+
+#ifndef CAPTURE_STORM_GATE
+#define CAPTURE_STORM_GATE 0
+#endif
+
+// edges per storm check and the edge rate (edges per second) above which they can be a storm
+#ifndef CAPTURE_STORM_WINDOW_EDGES
+#define CAPTURE_STORM_WINDOW_EDGES 32
+#endif
+
+#ifndef CAPTURE_STORM_RATE
+#define CAPTURE_STORM_RATE 2000
+#endif
+
+// durations shorter than MIN_BUCKET_LENGTH and the shortest rcswitch pulse, a quarter of the window by default
+#ifndef CAPTURE_STORM_SHORT_US
+#define CAPTURE_STORM_SHORT_US 100
+#endif
+
+#ifndef CAPTURE_STORM_SHORT_EDGES
+#define CAPTURE_STORM_SHORT_EDGES (CAPTURE_STORM_WINDOW_EDGES / 4)
+#endif
+
+#define CAPTURE_STORM_SHORT_COUNTS  US_TO_CAPTURE_COUNTS(CAPTURE_STORM_SHORT_US)
+#define CAPTURE_STORM_WINDOW_COUNTS US_TO_CAPTURE_COUNTS(1000000UL * CAPTURE_STORM_WINDOW_EDGES / CAPTURE_STORM_RATE)
+
+#if CAPTURE_STORM_GATE == 1
+
+// same as CAPTURE_STORM_WINDOW_COUNTS without the cast, which the preprocessor can not evaluate
+#if (1000000UL * CAPTURE_STORM_WINDOW_EDGES / CAPTURE_STORM_RATE) * (MCU_FREQ / 1000UL) / (CAPTURE_PRESCALER * 1000UL) >= 0xFFFF
+#error "CAPTURE_STORM_WINDOW_EDGES / CAPTURE_STORM_RATE must fit into 16 bit capture counts"
+#endif
+
+#if CAPTURE_STORM_WINDOW_EDGES > 255
+#error "CAPTURE_STORM_WINDOW_EDGES must fit into 8 bit"
+#endif
+
+// shortest duration in capture counts which reopens the gate, set by the decoder
+// (16 bit, so write it with the capture interrupt disabled)
+extern __xdata uint16_t capture_gate_counts;
+
+// true while edges are ignored
+extern __xdata volatile bool capture_gate_closed;
+
+#if RF_STATS == 1
+// edges ignored while the gate was closed
+extern __xdata uint16_t capture_gate_ignored;
+#endif
+
+// called by the capture interrupt with the capture counts of each edge,
+// returns false if the edge is ignored and only the counter has to be restarted
+extern bool capture_gate(const uint16_t counts);
+
+#endif // CAPTURE_STORM_GATE == 1
+
+#endif // INC_CAPTURE_GATE_H_
@@ -0,0 +1,43 @@
+/*
+ * capture_ticks.h - unit of the durations measured by capture_handler()
+ *
+ *  By default capture_handler() converts capture counts to microseconds
+ *  with countsToTime() and the decoders compare against microseconds.
+ *  Building with CAPTURE_NATIVE_TICKS=1 (NATIVE_TICKS=1 in the makefile) skips that
+ *  conversion inside the interrupt: durations stay in capture counts ("ticks") and
+ *  the timing constants of the decoders are converted at compile time instead.
+ *  Timings only go back to microseconds when they are reported over UART.
+ *
+ *  MCU_FREQ (Hz) and CAPTURE_PRESCALER (system clocks per capture count)
+ *  are passed by the makefile.
+ */
+
+#ifndef INC_CAPTURE_TICKS_H_
+#define INC_CAPTURE_TICKS_H_
+
+#include <stdint.h>
+
+#ifndef CAPTURE_NATIVE_TICKS
+#define CAPTURE_NATIVE_TICKS 0
+#endif
+
+// rounded conversions between microseconds and capture counts, constant arguments are folded by the compiler
+#define US_TO_CAPTURE_COUNTS(us)     (((uint32_t)(us) * (MCU_FREQ / 1000UL) + CAPTURE_PRESCALER * 500UL) / (CAPTURE_PRESCALER * 1000UL))
+#define CAPTURE_COUNTS_TO_US(counts) (((uint32_t)(counts) * (CAPTURE_PRESCALER * 1000UL) + MCU_FREQ / 2000UL) / (MCU_FREQ / 1000UL))
+
+#if CAPTURE_NATIVE_TICKS == 1
+// decoder timings are capture counts, 16 bit so that comparisons stay 16 bit on the 8051
+#define US_TO_TICKS(us)    ((uint16_t)US_TO_CAPTURE_COUNTS(us))
+#define TICKS_TO_US(ticks) ((uint16_t)CAPTURE_COUNTS_TO_US(ticks))
+
+// Portisch keeps 15 bit durations, limited to what fits in 15 bit microseconds as well so reports do not overflow
+#define MAX_BUCKET_TICKS   ((US_TO_CAPTURE_COUNTS(0x7FFF) < 0x7FFF) ? US_TO_TICKS(0x7FFF) : 0x7FFF)
+#else
+// decoder timings are microseconds
+#define US_TO_TICKS(us)    (us)
+#define TICKS_TO_US(ticks) (ticks)
+
+#define MAX_BUCKET_TICKS   0x7FFF
+#endif
+
+#endif // INC_CAPTURE_TICKS_H_
@@ -0,0 +1,51 @@
+/*
+ * capture_timer.h - optional free-running capture timer with software overflow extension
+ *
+ *  By default clear_pca_counter() stops the capture timer, zeroes it and starts it again on
+ *  every edge, so the capture register holds the duration directly. The counts between the
+ *  capture and the restart are lost from every duration, and a gap longer than the 16 bit
+ *  timer wraps around and looks short (after 98 ms on OB38S003, 32 ms on EFM8BB1).
+ *  Building with CAPTURE_FREE_RUNNING=1 (FREE_RUNNING=1 in the makefile) leaves the timer running.
+ *  The capture interrupt hands each captured timestamp to capture_duration(), which returns the
+ *  difference to the previous one. Timer overflows share the interrupt and are counted by
+ *  capture_timer_overflow(), so gaps are still measured across them. Decoders take 16 bit
+ *  durations, so measured ones end at 0xFFFE and anything longer is returned as
+ *  CAPTURE_GAP_COUNTS. That value flags a gap of unknown length rather than a duration (the glitch
+ *  filter saturates its sums to it as well): Portisch never turns it into a bucket, so it cannot
+ *  be taken for a sync, and rcswitch ends the frame without comparing it to the gap before.
+ *  clear_pca_counter() does nothing then.
+ *
+ *  An overflow flagged in the same interrupt as a capture happened before the capture
+ *  if the timestamp is in the lower half of the timer, otherwise after it.
+ *
+ *  Resolution against range is chosen with CAPTURE_PRESCALER in the makefile,
+ *  the drivers list the values their timer supports.
+ *  With CAPTURE_FREE_RUNNING=0 the functions and their variables are compiled out.
+ */
+
+#ifndef INC_CAPTURE_TIMER_H_
+#define INC_CAPTURE_TIMER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef CAPTURE_FREE_RUNNING
+#define CAPTURE_FREE_RUNNING 0
+#endif
+
+// duration of a gap too long for 16 bit capture counts
+#define CAPTURE_GAP_COUNTS 0xFFFF
+
+#if CAPTURE_FREE_RUNNING == 1
+
+// called by the capture interrupt for a timer overflow without a capture
+extern void capture_timer_overflow(void);
+
+// called by the capture interrupt with the captured timestamp and whether the overflow
+// flag was set as well (and cleared), returns the duration since the previous edge in capture counts
+// or CAPTURE_GAP_COUNTS if it was longer than 0xFFFE
+extern uint16_t capture_duration(const uint16_t timestamp, const bool overflowed);
+
+#endif // CAPTURE_FREE_RUNNING == 1
+
+#endif // INC_CAPTURE_TIMER_H_
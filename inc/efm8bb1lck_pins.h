@@ -17,6 +17,10 @@
 // software uart
 #define SOFT_TX_PIN P1_5
 
+// copy of RDATA when built with MIRROR=1 (see rdata_mirror.h)
+// same pin as SOFT_TX_PIN, rdata_mirror.h refuses builds that use both
+#define MIRROR_PIN  SOFT_TX_PIN
+
 // for reading by oscilloscope
 #define DEBUG_PIN01  P1_7
 
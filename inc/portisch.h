@@ -12,6 +12,7 @@
 #include <stdint.h>
 
 #include "portisch_config.h"
+#include "rf_stats.h"
 
 // FIXME: not able to follow the math here
 // e.g., 101 is not divisible by 4, 11, 4+11, nor 4*11
@@ -66,8 +67,35 @@ extern __xdata uint16_t buckets[7];
 // bucket sniffing
 extern __xdata uint16_t bucket_sync;
 extern __xdata uint8_t bucket_count;
+extern __xdata bool bucket_data_in_use;
 
 
+// 16 bit, so read it with the capture interrupt disabled
+extern __xdata volatile uint16_t buffer_buckets_overflows;
+// raw sniffing clears it after reporting, so read and clear it with the capture interrupt disabled
+extern __xdata volatile uint8_t buffer_buckets_dropped;
+
+#if RF_STATS == 1
+// see rf_stats.h, edges and noise are counted by the capture interrupt
+typedef struct RF_STATISTICS
+{
+	// durations passed to capture_handler()
+	volatile uint16_t edges;
+	// durations too long to be part of a frame, these reset all decodings
+	volatile uint16_t noise;
+	// durations shorter than MIN_BUCKET_LENGTH
+	uint16_t short_rejects;
+	// decodes suppressed because the crc matched the previous one within the debounce time
+	uint16_t debounced;
+	// decodes of bucket sniffing
+	uint16_t bucket_decodes;
+} RF_STATISTICS;
+
+extern __xdata RF_STATISTICS rf_stats;
+// decodes per protocol index, NUM_OF_PROTOCOLS entries
+extern __xdata uint16_t rf_stats_decodes[];
+#endif
+
 extern bool buffer_out(uint16_t* bucket);
 extern void HandleRFBucket(uint16_t duration, bool high_low);
 extern uint8_t PCA0_DoSniffing(void);
@@ -76,6 +104,11 @@ extern void SendRFBuckets(uint16_t* buckets, uint8_t* rfdata, uint8_t data_len);
 extern void SendBuckets(uint16_t *pulses,uint8_t* start, uint8_t start_size,uint8_t* bit0, uint8_t bit0_size,uint8_t* bit1, uint8_t bit1_size,uint8_t* end, uint8_t end_size,uint8_t bit_count,uint8_t* rfdata);
 extern void SendBucketsByIndex(uint8_t index, uint8_t* rfdata);
 extern void Bucket_Received(uint16_t duration, bool high_low);
+// debounce crc step for one decoded byte, see PORTISCH_CRC8_TABLE
+extern uint8_t Compute_CRC8_Simple_OneByte(uint8_t byteVal);
+// decoded codes are only reported after the given number of identical frames in a row until stop_learning()
+extern void start_learning(uint8_t repeats);
+extern void stop_learning(void);
 
 void capture_handler(uint16_t current_capture_value);
 
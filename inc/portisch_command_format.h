@@ -44,7 +44,11 @@ typedef enum
 	RF_CODE_LEARN_OK_NEW       = 0xAB,
 	RF_CODE_RFOUT_BUCKET       = 0xB0,
 	RF_CODE_SNIFFING_ON_BUCKET = 0xB1,
+	// not in the original portisch firmware, streams every captured duration (see uart_stream_RF_raw())
+	RF_CODE_SNIFFING_ON_RAW    = 0xB2,
 	RF_DO_BEEP                 = 0xC0,
+	// not in the original portisch firmware, requires building with STATS=1 (see rf_stats.h)
+	RF_CODE_STATS              = 0xD0,
     RF_RESET_MCU               = 0xFE,
 	RF_ALTERNATIVE_FIRMWARE    = 0xFF
 } uart_command_t;
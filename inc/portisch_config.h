@@ -7,8 +7,14 @@
  *  Enable/Disable the protocols you want to include when compiling
  *  The memory of the used EFM8BB1 is limited to 8KB
  *
+ *  Host tools may point PORTISCH_CONFIG_FILE at their own selection instead
+ *  (e.g., bench/portisch_config_all.h)
+ *
  */
 
+#if defined(PORTISCH_CONFIG_FILE)
+#include PORTISCH_CONFIG_FILE
+#else
 
 // typical protocols, disable here!             Enable	Remarks
 #define EFM8BB1_SUPPORT_PT226X_PROTOCOL			1		// PT2260, EV1527,... original RF bridge protocol
@@ -32,4 +38,17 @@
 #define EFM8BB1_SUPPORT_DOG_COLLAR_PROTOCOL		0		// Generic dog training collar - board label T-187-n (TX)-1, PR #100
 #define EFM8BB1_SUPPORT_BY302_PROTOCOL			0		// Byron BY302 Doorbell, Issue #102
 #define EFM8BB1_SUPPORT_DT_5514_PROTOCOL		0		// 5514 SILENT Dual Tech, Issue #104
-#define EFM8BB1_SUPPORT_H13726_PROTOCOL			0		// Auriol H13726 Weather Station, Issue #106
\ No newline at end of file
+#define EFM8BB1_SUPPORT_H13726_PROTOCOL			0		// Auriol H13726 Weather Station, Issue #106
+
+// decoder options                              Enable  Remarks
+#define PORTISCH_SHARED_BUCKETS					0		// ADVANCED: classify each duration once for all protocols, 5 bytes xram per bucket, helps with several protocols
+#define PORTISCH_SYNC_MASKS						0		// ADVANCED: track sync of all protocols as one bitmask per sync position, needs PORTISCH_SHARED_BUCKETS
+#define PORTISCH_BUFFER_BUCKETS_SIZE			4		// edges buffered for the main loop (one entry kept for a reset), power of two, 2 bytes xram each, more ride out bursts of noise
+#define PORTISCH_CRC8_TABLE						0		// debounce crc per decoded byte: 0 bit loop, 1 16 byte table in flash, 2 256 byte table in flash (fastest)
+#define PORTISCH_DEDUP_CACHE_SIZE				0		// codes remembered for debounce, 4 bytes xram each and uses timer 0, 0 remembers only the last code with the delay timer
+#define PORTISCH_DEDUP_HOLDOFF_MS				800		// a code is not reported again within this time, needs PORTISCH_DEDUP_CACHE_SIZE
+#define PORTISCH_LEARN_TIMEOUT_MS				30000	// learning (0xA1/0xA9) answers LEARN_KO when no code was received within this time, at most 65535
+#define PORTISCH_LEARN_REPEATS					2		// identical frames in a row before learning answers LEARN_OK
+#define PORTISCH_RAW_SHIFT						3		// raw sniffing (0xB2) sends durations in units of 2^n microseconds, 3 fits up to 504 us in one byte
+
+#endif
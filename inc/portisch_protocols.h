@@ -14,22 +14,28 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "capture_ticks.h"
 #include "portisch_macros.h"
 #include "portisch_config.h"
 
+/*
+ * timings are in microseconds, US_TO_TICKS() converts them to capture counts
+ * when built with CAPTURE_NATIVE_TICKS (see capture_ticks.h)
+ */
+
 /*
  * bucket sniffing constants
  */
-#define MIN_FOOTER_LENGTH	300
-#define MIN_BUCKET_LENGTH	100
+#define MIN_FOOTER_LENGTH	US_TO_TICKS(300)
+#define MIN_BUCKET_LENGTH	US_TO_TICKS(100)
 
-#define PT226x_SYNC_MIN		4500
+#define PT226x_SYNC_MIN		US_TO_TICKS(4500)
 
 /*
  * sync constants
  */
-#define TOLERANCE_MAX		500
-#define TOLERANCE_MIN		100
+#define TOLERANCE_MAX		US_TO_TICKS(500)
+#define TOLERANCE_MIN		US_TO_TICKS(100)
 
 /*
  * number of repeating by default
@@ -84,11 +90,13 @@ typedef struct BUCKET_PROTOCOL_DATA
  * http://www.princeton.com.tw/Portals/0/Product/PT2260_4.pdf
  */
 #if EFM8BB1_SUPPORT_PT226X_PROTOCOL == 1
-#define PT226X
-__code static uint16_t PROTOCOL_BUCKETS(PT226X)[] = { 350, 1050, 10850 };
+__code static uint16_t PROTOCOL_BUCKETS(PT226X)[] = { US_TO_TICKS(350), US_TO_TICKS(1050), US_TO_TICKS(10850) };
 __code static uint8_t  PROTOCOL_START(PT226X)[]   = { HIGH(0), LOW(2) };
 __code static uint8_t  PROTOCOL_BIT0(PT226X)[]    = { HIGH(0), LOW(1) };
 __code static uint8_t  PROTOCOL_BIT1(PT226X)[]    = { HIGH(1), LOW(0) };
+#define PROTOCOL_ENTRY_PT226X(ENTRY) ENTRY(PT226X)
+#else
+#define PROTOCOL_ENTRY_PT226X(ENTRY)
 #endif
 
 /*
@@ -96,12 +104,14 @@ __code static uint8_t  PROTOCOL_BIT1(PT226X)[]    = { HIGH(1), LOW(0) };
  * https://github.com/bjwelker/Raspi-Rollo/tree/master/Arduino/Rollo_Code_Receiver
  */
 #if EFM8BB1_SUPPORT_Rohrmotor24_PROTOCOL == 1
-#define Rohrmotor24
-__code static uint16_t PROTOCOL_BUCKETS(Rohrmotor24)[] = { 370, 740, 4800, 1500, 8400};
+__code static uint16_t PROTOCOL_BUCKETS(Rohrmotor24)[] = { US_TO_TICKS(370), US_TO_TICKS(740), US_TO_TICKS(4800), US_TO_TICKS(1500), US_TO_TICKS(8400) };
 __code static uint8_t PROTOCOL_START(Rohrmotor24)[] = { HIGH(2), LOW(3) };
 __code static uint8_t PROTOCOL_BIT0(Rohrmotor24)[]  = { HIGH(0), LOW(1) };
 __code static uint8_t PROTOCOL_BIT1(Rohrmotor24)[]  = { HIGH(1), LOW(0) };
 __code static uint8_t PROTOCOL_END(Rohrmotor24)[]   = { LOW(4) };
+#define PROTOCOL_ENTRY_Rohrmotor24(ENTRY) ENTRY(Rohrmotor24)
+#else
+#define PROTOCOL_ENTRY_Rohrmotor24(ENTRY)
 #endif
 
 /*
@@ -109,33 +119,39 @@ __code static uint8_t PROTOCOL_END(Rohrmotor24)[]   = { LOW(4) };
  * http://www.seamaid-lighting.com/de/produit/lampe-par56/
  */
 #if EFM8BB1_SUPPORT_PAR56_PROTOCOL == 1
-#define PAR56
-__code static uint16_t PROTOCOL_BUCKETS(PAR56)[] = { 380, 1100, 3000, 9000};
+__code static uint16_t PROTOCOL_BUCKETS(PAR56)[] = { US_TO_TICKS(380), US_TO_TICKS(1100), US_TO_TICKS(3000), US_TO_TICKS(9000) };
 __code static uint8_t PROTOCOL_START(PAR56)[] = { HIGH(2), LOW(3) };
 __code static uint8_t PROTOCOL_BIT0(PAR56)[]  = { HIGH(0), LOW(1) };
 __code static uint8_t PROTOCOL_BIT1(PAR56)[]  = { HIGH(1), LOW(0) };
+#define PROTOCOL_ENTRY_PAR56(ENTRY) ENTRY(PAR56)
+#else
+#define PROTOCOL_ENTRY_PAR56(ENTRY)
 #endif
 
 /*
  * Alecto WS-1200 Series Wireless Weather Station
  */
 #if EFM8BB1_SUPPORT_WS_1200_PROTOCOL == 1
-#define WS_1200
-__code static uint16_t PROTOCOL_BUCKETS(WS_1200)[] = { 500, 1000, 1500, 29500 };
+__code static uint16_t PROTOCOL_BUCKETS(WS_1200)[] = { US_TO_TICKS(500), US_TO_TICKS(1000), US_TO_TICKS(1500), US_TO_TICKS(29500) };
 __code static uint8_t PROTOCOL_START(WS_1200)[] = { LOW(3) };
 __code static uint8_t PROTOCOL_BIT0(WS_1200)[]  = { HIGH(2), LOW(1) };
 __code static uint8_t PROTOCOL_BIT1(WS_1200)[]  = { HIGH(0), LOW(1) };
+#define PROTOCOL_ENTRY_WS_1200(ENTRY) ENTRY(WS_1200)
+#else
+#define PROTOCOL_ENTRY_WS_1200(ENTRY)
 #endif
 
 /*
  * ALDI Remote controlled wall sockets, 4x
   */
 #if EFM8BB1_SUPPORT_ALDI_4x_PROTOCOL == 1
-#define ALDI_4x
-__code static uint16_t PROTOCOL_BUCKETS(ALDI_4x)[] = { 400, 1200, 3000, 7250};
+__code static uint16_t PROTOCOL_BUCKETS(ALDI_4x)[] = { US_TO_TICKS(400), US_TO_TICKS(1200), US_TO_TICKS(3000), US_TO_TICKS(7250) };
 __code static uint8_t PROTOCOL_START(ALDI_4x)[] = { HIGH(2), LOW(3) };
 __code static uint8_t PROTOCOL_BIT0(ALDI_4x)[]  = { HIGH(0), LOW(1) };
 __code static uint8_t PROTOCOL_BIT1(ALDI_4x)[]  = { HIGH(1), LOW(0) };
+#define PROTOCOL_ENTRY_ALDI_4x(ENTRY) ENTRY(ALDI_4x)
+#else
+#define PROTOCOL_ENTRY_ALDI_4x(ENTRY)
 #endif
 
 /*
@@ -143,11 +159,13 @@ __code static uint8_t PROTOCOL_BIT1(ALDI_4x)[]  = { HIGH(1), LOW(0) };
  * http://www.holtek.com.tw/documents/10179/11842/6p20v170.pdf
  */
 #if EFM8BB1_SUPPORT_HT6P20X_PROTOCOL == 1
-#define HT6P20X
-__code static uint16_t PROTOCOL_BUCKETS(HT6P20X)[] = { 450, 900, 10350};
+__code static uint16_t PROTOCOL_BUCKETS(HT6P20X)[] = { US_TO_TICKS(450), US_TO_TICKS(900), US_TO_TICKS(10350) };
 __code static uint8_t PROTOCOL_START(HT6P20X)[]    = { LOW(2), HIGH(0) };
 __code static uint8_t PROTOCOL_BIT0(HT6P20X)[]     = { LOW(0), HIGH(1) };
 __code static uint8_t PROTOCOL_BIT1(HT6P20X)[]     = { LOW(1), HIGH(0) };
+#define PROTOCOL_ENTRY_HT6P20X(ENTRY) ENTRY(HT6P20X)
+#else
+#define PROTOCOL_ENTRY_HT6P20X(ENTRY)
 #endif
 
 /*
@@ -155,11 +173,13 @@ __code static uint8_t PROTOCOL_BIT1(HT6P20X)[]     = { LOW(1), HIGH(0) };
  * http://www.holtek.com/documents/10179/116711/2_12ev120.pdf
  */
 #if EFM8BB1_SUPPORT_HT12_PROTOCOL == 1
-#define HT12
-__code static uint16_t PROTOCOL_BUCKETS(HT12)[] = { 330, 630, 10830};
+__code static uint16_t PROTOCOL_BUCKETS(HT12)[] = { US_TO_TICKS(330), US_TO_TICKS(630), US_TO_TICKS(10830) };
 __code static uint8_t PROTOCOL_START(HT12)[]    = { LOW(2), HIGH(0) };
 __code static uint8_t PROTOCOL_BIT0(HT12)[]     = { LOW(0), HIGH(1) };
 __code static uint8_t PROTOCOL_BIT1(HT12)[]     = { LOW(1), HIGH(0) };
+#define PROTOCOL_ENTRY_HT12(ENTRY) ENTRY(HT12)
+#else
+#define PROTOCOL_ENTRY_HT12(ENTRY)
 #endif
 
 /*
@@ -167,11 +187,13 @@ __code static uint8_t PROTOCOL_BIT1(HT12)[]     = { LOW(1), HIGH(0) };
  * http://www.holtek.com/documents/10179/116711/2_12ev120.pdf
  */
 #if EFM8BB1_SUPPORT_HT12a_PROTOCOL == 1
-#define HT12a
-__code static uint16_t PROTOCOL_BUCKETS(HT12a)[] = { 200, 380, 6950};
+__code static uint16_t PROTOCOL_BUCKETS(HT12a)[] = { US_TO_TICKS(200), US_TO_TICKS(380), US_TO_TICKS(6950) };
 __code static uint8_t PROTOCOL_START(HT12a)[] = { LOW(2), HIGH(0) };
 __code static uint8_t PROTOCOL_BIT0(HT12a)[]  = { LOW(0), HIGH(1) };
 __code static uint8_t PROTOCOL_BIT1(HT12a)[]  = { LOW(1), HIGH(0) };
+#define PROTOCOL_ENTRY_HT12a(ENTRY) ENTRY(HT12a)
+#else
+#define PROTOCOL_ENTRY_HT12a(ENTRY)
 #endif
 
 /*
@@ -179,11 +201,13 @@ __code static uint8_t PROTOCOL_BIT1(HT12a)[]  = { LOW(1), HIGH(0) };
  * http://www.holtek.com/documents/10179/116711/2_12ev120.pdf
  */
 #if EFM8BB1_SUPPORT_HT12_Atag_PROTOCOL == 1
-#define HT12b
-__code static uint16_t PROTOCOL_BUCKETS(HT12b)[] = { 350, 650, 13000};
+__code static uint16_t PROTOCOL_BUCKETS(HT12b)[] = { US_TO_TICKS(350), US_TO_TICKS(650), US_TO_TICKS(13000) };
 __code static uint8_t PROTOCOL_START(HT12b)[] = { LOW(2), HIGH(0) };
 __code static uint8_t PROTOCOL_BIT0(HT12b)[]  = { LOW(0), HIGH(1) };
 __code static uint8_t PROTOCOL_BIT1(HT12b)[]  = { LOW(1), HIGH(0) };
+#define PROTOCOL_ENTRY_HT12b(ENTRY) ENTRY(HT12b)
+#else
+#define PROTOCOL_ENTRY_HT12b(ENTRY)
 #endif
 
 /*
@@ -191,11 +215,13 @@ __code static uint8_t PROTOCOL_BIT1(HT12b)[]  = { LOW(1), HIGH(0) };
  * http://www.holtek.com/documents/10179/116711/2_12ev120.pdf
  */
 #if EFM8BB1_SUPPORT_HT12_Atag_PROTOCOL == 1
-#define HT12c
-__code static uint16_t PROTOCOL_BUCKETS(HT12c)[] = { 350, 700, 15650};
+__code static uint16_t PROTOCOL_BUCKETS(HT12c)[] = { US_TO_TICKS(350), US_TO_TICKS(700), US_TO_TICKS(15650) };
 __code static uint8_t PROTOCOL_START(HT12c)[] = { LOW(2), HIGH(0) };
-__code static uint8_tPROTOCOL_BIT0(HT12c)[]   = { LOW(0), HIGH(1) };
+__code static uint8_t PROTOCOL_BIT0(HT12c)[]  = { LOW(0), HIGH(1) };
 __code static uint8_t PROTOCOL_BIT1(HT12c)[]  = { LOW(1), HIGH(0) };
+#define PROTOCOL_ENTRY_HT12c(ENTRY) ENTRY(HT12c)
+#else
+#define PROTOCOL_ENTRY_HT12c(ENTRY)
 #endif
 
 /*
@@ -203,125 +229,147 @@ __code static uint8_t PROTOCOL_BIT1(HT12c)[]  = { LOW(1), HIGH(0) };
  * https://gist.github.com/klaper/ce3ba02501516d9a6d294367d2c300a6
  */
 #if EFM8BB1_SUPPORT_SP45_PROTOCOL == 1
-#define SP45
-__code static uint16_t PROTOCOL_BUCKETS(SP45)[] = { 650, 7810, 1820, 3980 };
+__code static uint16_t PROTOCOL_BUCKETS(SP45)[] = { US_TO_TICKS(650), US_TO_TICKS(7810), US_TO_TICKS(1820), US_TO_TICKS(3980) };
 __code static uint8_t PROTOCOL_START(SP45)[] = { HIGH(0), LOW(1) };
 __code static uint8_t PROTOCOL_BIT0(SP45)[]  = { HIGH(0), LOW(2) };
 __code static uint8_t PROTOCOL_BIT1(SP45)[]  = { HIGH(0), LOW(3) };
+#define PROTOCOL_ENTRY_SP45(ENTRY) ENTRY(SP45)
+#else
+#define PROTOCOL_ENTRY_SP45(ENTRY)
 #endif
 
 /*
  * Dooya DC90 remote
  */
 #if EFM8BB1_SUPPORT_DC90_PROTOCOL == 1
-#define DC90
-__code static uint16_t PROTOCOL_BUCKETS(DC90)[] = { 360, 720, 4800, 1500 };
+__code static uint16_t PROTOCOL_BUCKETS(DC90)[] = { US_TO_TICKS(360), US_TO_TICKS(720), US_TO_TICKS(4800), US_TO_TICKS(1500) };
 __code static uint8_t PROTOCOL_START(DC90)[] = { HIGH(2), LOW(3) };
 __code static uint8_t PROTOCOL_BIT0(DC90)[]  = { HIGH(0), LOW(1) };
 __code static uint8_t PROTOCOL_BIT1(DC90)[]  = { HIGH(1), LOW(0) };
+#define PROTOCOL_ENTRY_DC90(ENTRY) ENTRY(DC90)
+#else
+#define PROTOCOL_ENTRY_DC90(ENTRY)
 #endif
 
 /*
  * Digoo DG-HOSA Smart 433MHz Wireless Household Carbon Monoxide Sensor
  */
 #if EFM8BB1_SUPPORT_DG_HOSA_PROTOCOL == 1
-#define DG_HOSA
-__code static uint16_t PROTOCOL_BUCKETS(DG_HOSA)[] = { 590, 1500, 430, 13450 };
+__code static uint16_t PROTOCOL_BUCKETS(DG_HOSA)[] = { US_TO_TICKS(590), US_TO_TICKS(1500), US_TO_TICKS(430), US_TO_TICKS(13450) };
 __code static uint8_t PROTOCOL_START(DG_HOSA)[] = { HIGH(2), LOW(3) };
 __code static uint8_t PROTOCOL_BIT0(DG_HOSA)[]  = { HIGH(0), LOW(1) };
 __code static uint8_t PROTOCOL_BIT1(DG_HOSA)[]  = { HIGH(1), LOW(0) };
+#define PROTOCOL_ENTRY_DG_HOSA(ENTRY) ENTRY(DG_HOSA)
+#else
+#define PROTOCOL_ENTRY_DG_HOSA(ENTRY)
 #endif
 
 /*
  * KaKu wall sockets
  */
 #if EFM8BB1_SUPPORT_Kaku_PROTOCOL == 1
-#define KaKu
-__code static uint16_t PROTOCOL_BUCKETS(KaKu)[] = { 300, 2560, 140, 1150, 10230 };
+__code static uint16_t PROTOCOL_BUCKETS(KaKu)[] = { US_TO_TICKS(300), US_TO_TICKS(2560), US_TO_TICKS(140), US_TO_TICKS(1150), US_TO_TICKS(10230) };
 __code static uint8_t PROTOCOL_START(KaKu)[] = {  HIGH(0), LOW(1) };
 __code static uint8_t PROTOCOL_BIT0(KaKu)[]  = {  HIGH(0), LOW(3),  HIGH(0), LOW(2) };
 __code static uint8_t PROTOCOL_BIT1(KaKu)[]  = {  HIGH(0), LOW(2),  HIGH(0), LOW(3) };
 __code static uint8_t PROTOCOL_END(KaKu)[]   = {  HIGH(0), LOW(4) };
+#define PROTOCOL_ENTRY_KaKu(ENTRY) ENTRY(KaKu)
+#else
+#define PROTOCOL_ENTRY_KaKu(ENTRY)
 #endif
 
 /*
  * DIO Chacon RF 433Mhz #95
  */
 #if EFM8BB1_SUPPORT_DIO_PROTOCOL == 1
-#define DIO_emg
-__code static uint16_t PROTOCOL_BUCKETS(DIO_emg)[] = { 260, 2714, 1300, 10400 };
+__code static uint16_t PROTOCOL_BUCKETS(DIO_emg)[] = { US_TO_TICKS(260), US_TO_TICKS(2714), US_TO_TICKS(1300), US_TO_TICKS(10400) };
 __code static uint8_t PROTOCOL_START(DIO_emg)[] = { HIGH(0), LOW(1) };
 __code static uint8_t PROTOCOL_BIT0(DIO_emg)[]  = { HIGH(0), LOW(0), HIGH(0), LOW(2) };
 __code static uint8_t PROTOCOL_BIT1(DIO_emg)[]  = { HIGH(0), LOW(2), HIGH(0), LOW(0) };
 __code static uint8_t PROTOCOL_END(DIO_emg)[]   = { HIGH(0), LOW(3) };
+#define PROTOCOL_ENTRY_DIO_emg(ENTRY) ENTRY(DIO_emg)
+#else
+#define PROTOCOL_ENTRY_DIO_emg(ENTRY)
 #endif
 
 /*
  * 1ByOne Doorbell, PR #97
  */
 #if EFM8BB1_SUPPORT_1BYONE_PROTOCOL == 1
-#define OneByOne
-__code static uint16_t PROTOCOL_BUCKETS(OneByOne)[] = { 370, 1080, 6530 };
+__code static uint16_t PROTOCOL_BUCKETS(OneByOne)[] = { US_TO_TICKS(370), US_TO_TICKS(1080), US_TO_TICKS(6530) };
 __code static uint8_t PROTOCOL_START(OneByOne)[] = { LOW(2), HIGH(0) };
 __code static uint8_t PROTOCOL_BIT0(OneByOne)[]  = { LOW(1), HIGH(0) };
 __code static uint8_t PROTOCOL_BIT1(OneByOne)[]  = { LOW(0), HIGH(1) };
+#define PROTOCOL_ENTRY_OneByOne(ENTRY) ENTRY(OneByOne)
+#else
+#define PROTOCOL_ENTRY_OneByOne(ENTRY)
 #endif
 
 /*
  * Prologue Sensor #96
  */
 #if EFM8BB1_SUPPORT_Prologue_PROTOCOL == 1
-#define Prologue
-__code static uint16_t PROTOCOL_BUCKETS(Prologue)[] = { 660, 2000, 4000, 9000 };
+__code static uint16_t PROTOCOL_BUCKETS(Prologue)[] = { US_TO_TICKS(660), US_TO_TICKS(2000), US_TO_TICKS(4000), US_TO_TICKS(9000) };
 __code static uint8_t PROTOCOL_START(Prologue)[] = { HIGH(0), LOW(3) };
 __code static uint8_t PROTOCOL_BIT0(Prologue)[]  = { HIGH(0), LOW(1) };
 __code static uint8_t PROTOCOL_BIT1(Prologue)[]  = { HIGH(0), LOW(2) };
 __code static uint8_t PROTOCOL_END(Prologue)[]   = { HIGH(0), LOW(1) };
+#define PROTOCOL_ENTRY_Prologue(ENTRY) ENTRY(Prologue)
+#else
+#define PROTOCOL_ENTRY_Prologue(ENTRY)
 #endif
 
 /*
  * T-187-N (TX)-1 Generic Dog Training Collar Remote Control
  */
 #if EFM8BB1_SUPPORT_DOG_COLLAR_PROTOCOL == 1
-#define DogCollar
-__code static uint16_t PROTOCOL_BUCKETS(DogCollar)[] = { 1560, 720, 210 };
+__code static uint16_t PROTOCOL_BUCKETS(DogCollar)[] = { US_TO_TICKS(1560), US_TO_TICKS(720), US_TO_TICKS(210) };
 __code static uint8_t PROTOCOL_START(DogCollar)[] = { HIGH(0), LOW(1) };
 __code static uint8_t PROTOCOL_BIT0(DogCollar)[]  = { HIGH(2), LOW(1) };
 __code static uint8_t PROTOCOL_BIT1(DogCollar)[]  = { HIGH(1), LOW(2) };
 __code static uint8_t PROTOCOL_END(DogCollar)[]   = { HIGH(2), LOW(1) };
+#define PROTOCOL_ENTRY_DogCollar(ENTRY) ENTRY(DogCollar)
+#else
+#define PROTOCOL_ENTRY_DogCollar(ENTRY)
 #endif
 
 /*
  * Byron BY302 Doorbell
  */
 #if EFM8BB1_SUPPORT_BY302_PROTOCOL == 1
-#define BY302
-__code static uint16_t PROTOCOL_BUCKETS(BY302)[] = { 470, 1020, 3070 };
+__code static uint16_t PROTOCOL_BUCKETS(BY302)[] = { US_TO_TICKS(470), US_TO_TICKS(1020), US_TO_TICKS(3070) };
 __code static uint8_t PROTOCOL_START(BY302)[] = { LOW(2), HIGH(0) };
 __code static uint8_t PROTOCOL_BIT0(BY302)[]  = { LOW(1), HIGH(0) };
 __code static uint8_t PROTOCOL_BIT1(BY302)[]  = { LOW(0), HIGH(1) };
+#define PROTOCOL_ENTRY_BY302(ENTRY) ENTRY(BY302)
+#else
+#define PROTOCOL_ENTRY_BY302(ENTRY)
 #endif
 
 /*
  * 5514 SILENT Dual Tech
  */
 #if EFM8BB1_SUPPORT_DT_5514_PROTOCOL == 1
-#define DT_5514
-__code static uint16_t PROTOCOL_BUCKETS(DT_5514)[] = { 400, 720, 4910 };
+__code static uint16_t PROTOCOL_BUCKETS(DT_5514)[] = { US_TO_TICKS(400), US_TO_TICKS(720), US_TO_TICKS(4910) };
 __code static uint8_t PROTOCOL_START(DT_5514)[] = { LOW(1), HIGH(2) };
 __code static uint8_t PROTOCOL_BIT0(DT_5514)[]  = { LOW(0), HIGH(1) };
 __code static uint8_t PROTOCOL_BIT1(DT_5514)[]  = { LOW(1), HIGH(0) };
+#define PROTOCOL_ENTRY_DT_5514(ENTRY) ENTRY(DT_5514)
+#else
+#define PROTOCOL_ENTRY_DT_5514(ENTRY)
 #endif
 
 /*
  * Auriol H13726 Weather Station
  */
 #if EFM8BB1_SUPPORT_H13726_PROTOCOL == 1
-#define H13726
-__code static uint16_t PROTOCOL_BUCKETS(H13726)[] = { 560, 1910, 3890, 8820 };
+__code static uint16_t PROTOCOL_BUCKETS(H13726)[] = { US_TO_TICKS(560), US_TO_TICKS(1910), US_TO_TICKS(3890), US_TO_TICKS(8820) };
 __code static uint8_t PROTOCOL_START(H13726)[] = { LOW(3), HIGH(0) };
 __code static uint8_t PROTOCOL_BIT0(H13726)[]  = { LOW(1), HIGH(0) };
 __code static uint8_t PROTOCOL_BIT1(H13726)[]  = { LOW(2), HIGH(0) };
+#define PROTOCOL_ENTRY_H13726(ENTRY) ENTRY(H13726)
+#else
+#define PROTOCOL_ENTRY_H13726(ENTRY)
 #endif
 
 __code static struct BUCKET_PROTOCOL_DATA PROTOCOL_DATA[] =
@@ -603,4 +651,46 @@ __code static struct BUCKET_PROTOCOL_DATA PROTOCOL_DATA[] =
 
 // https://www.ashn.dev/blog/2020-01-06-c-array-length.html
 #define NUM_OF_PROTOCOLS (sizeof(PROTOCOL_DATA) / sizeof(PROTOCOL_DATA[0]))
+
+/*
+ * every enabled protocol as ENTRY(name), empty for disabled ones (see the PROTOCOL_ENTRY_ definitions above),
+ * the counts below are derived from it instead of being maintained by hand
+ */
+#define PROTOCOL_ENTRIES(ENTRY) \
+	PROTOCOL_ENTRY_PT226X(ENTRY) \
+	PROTOCOL_ENTRY_Rohrmotor24(ENTRY) \
+	PROTOCOL_ENTRY_PAR56(ENTRY) \
+	PROTOCOL_ENTRY_WS_1200(ENTRY) \
+	PROTOCOL_ENTRY_ALDI_4x(ENTRY) \
+	PROTOCOL_ENTRY_HT6P20X(ENTRY) \
+	PROTOCOL_ENTRY_HT12(ENTRY) \
+	PROTOCOL_ENTRY_HT12a(ENTRY) \
+	PROTOCOL_ENTRY_HT12b(ENTRY) \
+	PROTOCOL_ENTRY_HT12c(ENTRY) \
+	PROTOCOL_ENTRY_SP45(ENTRY) \
+	PROTOCOL_ENTRY_DC90(ENTRY) \
+	PROTOCOL_ENTRY_DG_HOSA(ENTRY) \
+	PROTOCOL_ENTRY_KaKu(ENTRY) \
+	PROTOCOL_ENTRY_DIO_emg(ENTRY) \
+	PROTOCOL_ENTRY_OneByOne(ENTRY) \
+	PROTOCOL_ENTRY_Prologue(ENTRY) \
+	PROTOCOL_ENTRY_DogCollar(ENTRY) \
+	PROTOCOL_ENTRY_BY302(ENTRY) \
+	PROTOCOL_ENTRY_DT_5514(ENTRY) \
+	PROTOCOL_ENTRY_H13726(ENTRY)
+
+#define PROTOCOL_COUNT_ONE(X)     + 1
+#define PROTOCOL_COUNT_BUCKETS(X) + ARRAY_LENGTH(PROTOCOL_BUCKETS(X))
+
+// total number of buckets of all enabled protocols, to size tables
+#define NUM_OF_PROTOCOL_BUCKETS (0 PROTOCOL_ENTRIES(PROTOCOL_COUNT_BUCKETS))
+
+// number of enabled protocols, usable by the preprocessor unlike NUM_OF_PROTOCOLS
+#define NUM_OF_PROTOCOLS_ENABLED (0 PROTOCOL_ENTRIES(PROTOCOL_COUNT_ONE))
+
+// a protocol added to PROTOCOL_DATA[] also needs its PROTOCOL_ENTRY_ in the list above
+_Static_assert(NUM_OF_PROTOCOLS_ENABLED == NUM_OF_PROTOCOLS, "PROTOCOL_ENTRIES does not match PROTOCOL_DATA[]");
+
+// longest start (sync) sequence of all protocols above
+#define PROTOCOL_MAX_START_SIZE 2
 #endif // INC_RF_PROTOCOLS_H_
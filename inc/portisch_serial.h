@@ -1,6 +1,7 @@
 #ifndef INC_SERIAL_H
 #define INC_SERIAL_H
 
+#include <stdbool.h>
 #include <stdint.h>
 
 //-----------------------------------------------------------------------------
@@ -16,5 +17,13 @@ extern void uart_put_RF_Data_Advanced(uint8_t command, uint8_t protocol_index);
 
 // bucket sniffing
 extern void uart_put_RF_buckets(uint8_t Command);
+extern bool uart_continue_RF_buckets(void);
+
+// raw sniffing
+extern void uart_start_RF_raw(void);
+extern void uart_stream_RF_raw(uint8_t command);
+
+// decode statistics
+extern void uart_put_RF_Stats(uint8_t command);
 
 #endif // INC_SERIAL_H
\ No newline at end of file
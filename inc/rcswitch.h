@@ -13,16 +13,39 @@
 #include <stdint.h>
 //#include <stdio.h>
 
+#include "capture_ticks.h"
+
 // original sui77/rc-switch stated:
 // we can handle up to (unsigned long) => 32 bit * 2 H/L changes per bit + 2 for sync
-#define RCSWITCH_MAX_CHANGES 67
+// codes are now collected in a byte array, so the limit is set by ram for the timings below
+#define RCSWITCH_MAX_DATA_BITS  64
+#define RCSWITCH_MAX_DATA_BYTES ((RCSWITCH_MAX_DATA_BITS + 7) / 8)
+#define RCSWITCH_MAX_CHANGES    (RCSWITCH_MAX_DATA_BITS * 2 + 3)
+
+// timings[] keeps one byte per duration in units of (1 << RCSWITCH_TIMING_SHIFT) microseconds or capture counts,
+// so data durations up to 255 units (about 4 ms) are stored, the gap before a frame is kept at full resolution
+#if CAPTURE_NATIVE_TICKS == 1 && (MCU_FREQ / CAPTURE_PRESCALER) > 1000000
+#define RCSWITCH_TIMING_SHIFT 5
+#else
+#define RCSWITCH_TIMING_SHIFT 4
+#endif
+
+// 1 stores durations on a log scale instead (three bit exponent, five bit mantissa) in units of
+// (1 << RCSWITCH_LOG_SHIFT), so the error is at most 1/64 of a duration instead of half a linear unit
+// which keeps short pulses more accurate and still reaches about 8 ms
+#ifndef RCSWITCH_LOG_TIMINGS
+#define RCSWITCH_LOG_TIMINGS 0
+#endif
+
+#define RCSWITCH_LOG_SHIFT (RCSWITCH_TIMING_SHIFT - 3)
 
 // see comment below - I do not think these would ever be changed while the system is running
 // so just define as constants here to save on memory space
 // percent
 #define N_RECEIVE_TOLERANCE   60
-// microseconds
-#define N_SEPARATION_LIMIT  4300
+// microseconds (converted to capture counts with CAPTURE_NATIVE_TICKS)
+#define N_SEPARATION_LIMIT_US 4300
+#define N_SEPARATION_LIMIT  US_TO_TICKS(N_SEPARATION_LIMIT_US)
 
 // number of repeating by default
 //#define RF_TRANSMIT_REPEATS 8
@@ -98,11 +121,18 @@ struct Pulse
 extern bool available(void);
 extern void reset_available(void);
 
-extern unsigned long get_received_value(void);
+// received code, most significant byte first and right aligned in get_received_bytelength() bytes
+extern uint8_t*      get_received_data(void);
 extern uint8_t       get_received_bitlength(void);
+extern uint8_t       get_received_bytelength(void);
 extern uint16_t      get_received_delay(void);
 extern uint8_t       get_received_protocol(void);
 extern int           get_received_tolerance(void);
+extern uint16_t      get_received_sync(void);
+// sync and shorter and longer duration of each bit, averaged over repeats of the received code
+extern uint16_t      get_average_sync(void);
+extern uint16_t      get_average_short(void);
+extern uint16_t      get_average_long(void);
 
 
 //void setProtocol(struct Protocol protocol);
@@ -110,6 +140,7 @@ extern int           get_received_tolerance(void);
 //void setProtocol(int nProtocol, int nPulseLength);
 
 extern bool receive_protocol(const int p, unsigned int changeCount);
+extern bool decode_frame(void);
 extern bool radio_tx_blocking(const uint8_t totalRepeats, const int protocolID);
 extern void capture_handler(const uint16_t);
 
@@ -119,10 +150,15 @@ void setProtocol(const struct Protocol pro);
 void send(struct Pulse* pro, unsigned char* packetPtr, const unsigned char bitsInPacket);
 
 
-extern volatile __xdata uint16_t timings[RCSWITCH_MAX_CHANGES];
+extern volatile __xdata uint8_t timings[RCSWITCH_MAX_CHANGES];
 
 
 extern const struct Protocol protocols[];
 extern const unsigned int numProto;
 
+#if defined(RCSWITCH_COUNT_CALLS)
+extern unsigned long rcswitchProtocolCalls;
+extern unsigned long rcswitchProtocolCallsAvoided;
+#endif
+
 #endif // RC_SWITCH_H
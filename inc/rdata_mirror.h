@@ -0,0 +1,39 @@
+/*
+ * rdata_mirror.h - optional copy of the receiver output for the ESP8265 while decoding
+ *
+ *  Building with RDATA_MIRROR=1 (MIRROR=1 in the makefile) makes the capture interrupt of the
+ *  Portisch and rcswitch images write the RDATA level to MIRROR_PIN (see the board pins header)
+ *  before the edge is measured, as the passthrough image does with the uart tx pin.
+ *  Wired to a free ESP8265 gpio this gives a hybrid: codes the firmware decodes still arrive
+ *  over uart and the ESP only needs to decode the raw signal (e.g., with remote_receiver)
+ *  for protocols the firmware does not know, or to cross check decodes.
+ *  The copy follows each edge within the interrupt entry, i.e. some register pushes later than passthrough.
+ *  With RDATA_MIRROR=0 nothing is compiled in.
+ *
+ *  On every board MIRROR_PIN is the pin the software uart transmits on (SOFT_TX_PIN, or the
+ *  reset pin on R2.2), so the two cannot be used together. SOFTWARE_UART=1 marks builds that
+ *  enable the software uart in main_rcswitch.c.
+ */
+
+#ifndef INC_RDATA_MIRROR_H_
+#define INC_RDATA_MIRROR_H_
+
+#ifndef RDATA_MIRROR
+#define RDATA_MIRROR 0
+#endif
+
+#ifndef SOFTWARE_UART
+#define SOFTWARE_UART 0
+#endif
+
+#if RDATA_MIRROR == 1 && SOFTWARE_UART == 1
+#error "MIRROR_PIN is the software uart transmit pin, build with MIRROR=0 or without SOFTWARE_UART"
+#endif
+
+#if RDATA_MIRROR == 1
+#define MIRROR_RDATA() mirror_rdata_to_mirror_pin()
+#else
+#define MIRROR_RDATA() ((void)0)
+#endif
+
+#endif // INC_RDATA_MIRROR_H_
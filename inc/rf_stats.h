@@ -0,0 +1,24 @@
+/*
+ * rf_stats.h - optional counters for diagnosing missed receptions in the field
+ *
+ *  Building with RF_STATS=1 (STATS=1 in the makefile) counts captured edges,
+ *  dropped and rejected durations, decodes and uart traffic.
+ *  Portisch reports them with the RF_CODE_STATS command.
+ *  Counters are 16 bit and wrap around, so compare two readings.
+ *  With RF_STATS=0 the counters and their increments are compiled out.
+ */
+
+#ifndef INC_RF_STATS_H_
+#define INC_RF_STATS_H_
+
+#ifndef RF_STATS
+#define RF_STATS 0
+#endif
+
+#if RF_STATS == 1
+#define STATS_INC(counter) ((counter)++)
+#else
+#define STATS_INC(counter) ((void)0)
+#endif
+
+#endif // INC_RF_STATS_H_
@@ -14,6 +14,10 @@
 // software uart
 #define SOFT_TX_PIN P2_0
 
+// copy of RDATA when built with MIRROR=1 (see rdata_mirror.h), C2D pad of the programming header
+// same pin as SOFT_TX_PIN, rdata_mirror.h refuses builds that use both
+#define MIRROR_PIN  SOFT_TX_PIN
+
 // this is the buzzer pin so we would not normally use this on hardware without removing buzzer
 #define DEBUG_PIN01  P1_6
 
@@ -16,6 +16,10 @@
 // can be used with software uart
 #define RESET_PIN P1_5
 
+// copy of RDATA when built with MIRROR=1 (see rdata_mirror.h), wire the pad to a free ESP8265 gpio
+// as above the reset function must be disabled in SMAP AC utility when flashing, otherwise the copy resets the MCU
+#define MIRROR_PIN RESET_PIN
+
 // output from radio receiver
 #define RDATA     P1_6
 
@@ -11,6 +11,8 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "rf_stats.h"
+
 //-----------------------------------------------------------------------------
 // Global Constants
 //-----------------------------------------------------------------------------
@@ -40,11 +42,17 @@
 //-----------------------------------------------------------------------------
 // public variables
 //-----------------------------------------------------------------------------
+#if RF_STATS == 1
+// 16 bit, so read uart_rx_bytes with interrupts disabled
+extern __xdata volatile uint16_t uart_rx_bytes;
+extern __xdata uint16_t uart_tx_bytes;
+#endif
 
 // public prototypes
 extern void uart_init_tx_polling(void);
 extern bool is_uart_tx_finished(void);
 extern bool is_uart_tx_buffer_empty(void);
+extern uint8_t uart_tx_free(void);
 extern unsigned int uart_getc(void);
 extern void uart_putc(uint8_t txdata);
 extern void uart_write(uint8_t value);
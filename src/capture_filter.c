@@ -0,0 +1,89 @@
+/*
+ * capture_filter.c - glitch filter with adaptive noise floor, see capture_filter.h
+ *
+ *  Only called from the capture interrupt.
+ */
+
+#include "capture_filter.h"
+
+#if CAPTURE_GLITCH_FILTER == 1
+
+__xdata uint16_t capture_filter_counts;
+__xdata bool capture_filter_level;
+
+__xdata uint16_t capture_glitch_counts = CAPTURE_GLITCH_MIN_COUNTS;
+
+#if RF_STATS == 1
+__xdata uint16_t capture_glitches = 0;
+#endif
+
+// duration waiting for the next edge, starts out as a gap so that decoders begin with a reset
+static __xdata uint16_t held_counts = 0xFFFF;
+static __xdata bool held_level = false;
+
+// glitch waiting to be merged together with the duration after it
+static __xdata uint16_t glitch_counts;
+static __xdata bool glitch_pending = false;
+
+// edges and their total time since the noise floor was last updated
+static __xdata uint8_t window_edges = 0;
+static __xdata uint16_t window_counts = 0;
+
+bool capture_filter(const uint16_t counts, const bool level)
+{
+	uint16_t sum;
+
+	// noise floor follows the edge rate, total time saturates so slow windows stay slow
+	sum = window_counts + counts;
+	window_counts = (sum < counts) ? 0xFFFF : sum;
+
+	if (++window_edges == CAPTURE_NOISE_WINDOW_EDGES)
+	{
+		if (window_counts < CAPTURE_NOISE_FAST_COUNTS)
+		{
+			if (capture_glitch_counts <= CAPTURE_GLITCH_MAX_COUNTS - CAPTURE_GLITCH_STEP_COUNTS)
+				capture_glitch_counts += CAPTURE_GLITCH_STEP_COUNTS;
+		}
+		else if (window_counts > CAPTURE_NOISE_SLOW_COUNTS)
+		{
+			if (capture_glitch_counts >= CAPTURE_GLITCH_MIN_COUNTS + CAPTURE_GLITCH_STEP_COUNTS)
+				capture_glitch_counts -= CAPTURE_GLITCH_STEP_COUNTS;
+		}
+
+		window_edges = 0;
+		window_counts = 0;
+	}
+
+	// the duration after a glitch has the level of the held one again, so all three become one level
+	if (glitch_pending)
+	{
+		glitch_pending = false;
+
+		sum = glitch_counts + counts;
+		sum = (sum < counts) ? 0xFFFF : sum;
+		sum += held_counts;
+		held_counts = (sum < held_counts) ? 0xFFFF : sum;
+
+		return false;
+	}
+
+	if (counts < capture_glitch_counts)
+	{
+		glitch_counts = counts;
+		glitch_pending = true;
+
+		STATS_INC(capture_glitches);
+
+		return false;
+	}
+
+	capture_filter_counts = held_counts;
+	capture_filter_level = held_level;
+
+	held_counts = counts;
+	held_level = level;
+
+	return true;
+}
+
+#endif // CAPTURE_GLITCH_FILTER == 1
@@ -0,0 +1,65 @@
+/*
+ * capture_gate.c - load shedding during receiver noise storms, see capture_gate.h
+ *
+ *  Only called from the capture interrupt.
+ */
+
+#include "capture_gate.h"
+
+#if CAPTURE_STORM_GATE == 1
+
+__xdata uint16_t capture_gate_counts = 0;
+__xdata volatile bool capture_gate_closed = false;
+
+#if RF_STATS == 1
+__xdata uint16_t capture_gate_ignored = 0;
+#endif
+
+// edges, short ones among them and their total time since the last storm check
+static __xdata uint8_t window_edges = 0;
+static __xdata uint8_t window_shorts = 0;
+static __xdata uint16_t window_counts = 0;
+
+bool capture_gate(const uint16_t counts)
+{
+	uint16_t sum;
+
+	// cheap path while the noise lasts
+	if (capture_gate_closed)
+	{
+		if (counts < capture_gate_counts)
+		{
+			STATS_INC(capture_gate_ignored);
+			return false;
+		}
+
+		// could be a sync, so it starts full capture again
+		capture_gate_closed = false;
+		window_edges = 0;
+		window_shorts = 0;
+		window_counts = 0;
+
+		return true;
+	}
+
+	// total time saturates, so slow windows stay slow
+	sum = window_counts + counts;
+	window_counts = (sum < counts) ? 0xFFFF : sum;
+
+	if (counts < CAPTURE_STORM_SHORT_COUNTS)
+		window_shorts++;
+
+	if (++window_edges == CAPTURE_STORM_WINDOW_EDGES)
+	{
+		if (window_counts < CAPTURE_STORM_WINDOW_COUNTS && window_shorts >= CAPTURE_STORM_SHORT_EDGES && capture_gate_counts != 0)
+			capture_gate_closed = true;
+
+		window_edges = 0;
+		window_shorts = 0;
+		window_counts = 0;
+	}
+
+	return true;
+}
+
+#endif // CAPTURE_STORM_GATE == 1
@@ -0,0 +1,57 @@
+/*
+ * capture_timer.c - durations from a free-running capture timer, see capture_timer.h
+ *
+ *  Only called from the capture interrupt.
+ */
+
+#include "capture_timer.h"
+
+#if CAPTURE_FREE_RUNNING == 1
+
+// timestamp of the previous edge, the timer starts from zero
+static __xdata uint16_t previous_timestamp = 0;
+
+// overflows since the previous edge, two or more always mean a gap so it saturates
+static __xdata uint8_t overflows = 0;
+
+void capture_timer_overflow(void)
+{
+	if (overflows < 2)
+		overflows++;
+}
+
+uint16_t capture_duration(const uint16_t timestamp, const bool overflowed)
+{
+	uint16_t duration;
+	bool late = false;
+
+	if (overflowed)
+	{
+		// timer had not wrapped yet when the edge was captured
+		if (timestamp & 0x8000)
+			late = true;
+		else
+			capture_timer_overflow();
+	}
+
+	// one overflow fits into 16 bit as long as the timer did not pass the previous timestamp again
+	if (overflows > 1 || (overflows == 1 && timestamp >= previous_timestamp))
+	{
+		duration = CAPTURE_GAP_COUNTS;
+	}
+	else
+	{
+		duration = timestamp - previous_timestamp;
+
+		// a measured duration is never taken for a gap of unknown length
+		if (duration == CAPTURE_GAP_COUNTS)
+			duration--;
+	}
+
+	previous_timestamp = timestamp;
+	overflows = late ? 1 : 0;
+
+	return duration;
+}
+
+#endif // CAPTURE_FREE_RUNNING == 1
@@ -28,6 +28,28 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+// Mirrors the radio receiver output to the uart tx pin (and the uart rx pin to the transmitter)
+// so that the ESP8265 can decode and send with its own libraries, e.g. rc_switch or remote_receiver.
+//
+// Receiver edges are mirrored by the capture interrupt that the decoders use for timing
+// (timer 2 capture on OB38S003, PCA channel 0 on EFM8BB1), so the delay no longer depends on
+// where the main loop happens to be. The interrupt copies the pin before anything else and
+// calls no functions, so no registers are saved first. Cycle budget from edge to output pin:
+//
+//   current instruction finishes (ret is the longest in the loop)   0 - 5 clocks
+//   interrupt detected, call to the vector                          1 + 4 clocks
+//   ljmp to timer2_isr/pca0_isr                                     4 clocks
+//   jnb RDATA, then setb/clr UART_TX_PIN                            5 - 6 clocks
+//   total                                                           14 - 20 clocks
+//   OB38S003 at 16 MHz: 0.9 - 1.3 us, EFM8BB1 at 24.5 MHz: 0.6 - 0.8 us
+//
+// Clocks are from the CIP-51 instruction table of the EFM8BB1, the OB38S003 is assumed to be
+// the same kind of single cycle core. The variation (jitter) is only the instruction that was
+// running, as long as nothing disables interrupts: the main loop only refreshes the watchdog and
+// polls the uart rx pin. Polling both directions took one loop pass of jitter on every edge.
+// 'make sim-bench' measures this interrupt in the s51 simulator (classic 8052 machine cycles,
+// see bench/README.md).
+
 //-----------------------------------------------------------------------------
 // Includes
 //-----------------------------------------------------------------------------
@@ -52,6 +74,32 @@
 
 #include <stdint.h>
 
+// sdccman sec. 3.8.1 indicates isr prototype must appear or be included in the file containing main
+#if defined(TARGET_BOARD_OB38S003)
+    void timer2_isr(void) __interrupt (d_T2_Vector);
+#elif defined(TARGET_BOARD_EFM8BB1) || defined(TARGET_BOARD_EFM8BB1LCB)
+    void pca0_isr(void) __interrupt (PCA0_VECTOR);
+#endif
+
+// timer 2 captures both edges of RDATA, only the interrupt is used and not the captured count
+#if defined(TARGET_BOARD_OB38S003)
+void timer2_isr(void) __interrupt (d_T2_Vector)
+{
+    mirror_rdata_to_uart_tx();
+
+    // must be explicitly cleared on ob38s003
+    clear_capture_flag();
+}
+#elif defined(TARGET_BOARD_EFM8BB1) || defined(TARGET_BOARD_EFM8BB1LCB)
+// pca channel 0 captures both edges of RDATA, the only pca interrupt enabled
+void pca0_isr(void) __interrupt (PCA0_VECTOR)
+{
+    mirror_rdata_to_uart_tx();
+
+    clear_capture_flag();
+}
+#endif
+
 void startup_beep(void)
 {
     // FIXME: startup beep helpful or annoying?
@@ -87,9 +135,6 @@ int main (void)
     //unsigned long heartbeat = 0;
     
     // look for level transitions on pins rather than absolute level, so that we can count signal edges
-    bool        rdataLevelOld;
-    static bool rdataLevelNew = false;
-    
     bool        tdataLevelOld;
     static bool tdataLevelNew = false;
     
@@ -127,6 +172,20 @@ int main (void)
     
     // shows power is on
     led_on();
+    
+    // radio receiver edges are mirrored by the capture interrupt
+#if defined(TARGET_BOARD_OB38S003)
+    init_timer2_as_capture();
+#elif defined(TARGET_BOARD_EFM8BB1) || defined(TARGET_BOARD_EFM8BB1LCB)
+    pca0_init();
+    pca0_run();
+#endif
+    
+    // start from the current level, the interrupt follows every edge from here
+    mirror_rdata_to_uart_tx();
+    
+    enable_capture_interrupt();
+    enable_global_interrupts();
         
     // watchdog will force a reset, unless we periodically write to it, demonstrating loop is not stuck somewhere
     enable_watchdog();
@@ -137,23 +196,8 @@ int main (void)
         // if this is not periodically called, watchdog will force microcontroller reset
         refresh_watchdog();
     
-        // mirror radio pin levels to uart pins (used as gpio)
+        // radio pin levels are mirrored to uart tx pin (used as gpio) by the capture interrupt
         // so that ESP8265 can effectively decode the same signals
-        rdataLevelOld = rdataLevelNew;
-        rdataLevelNew = rdata_level();
-        
-        // look for a level change (i.e., an edge)
-        // explicitly setting pin output constantly, even with no change, is possibly a bad idea for some reason
-        if (rdataLevelOld != rdataLevelNew)
-        {
-            // radio receiver
-            if (rdataLevelNew)
-            {
-                uart_tx_pin_on();
-            } else {
-                uart_tx_pin_off();
-            }
-        }
 
         // FIXME: variable name may need to be changed (is actually uart rx pin level)
         tdataLevelOld = tdataLevelNew;
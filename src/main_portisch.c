@@ -19,6 +19,7 @@
 // for printf_tiny()
 //#include <stdio.h>
 
+#include "capture_timer.h"
 #include "delay.h"
 #include "hal.h"
 #include "portisch.h"
@@ -62,6 +63,14 @@ uint16_t* buckets_pointer;
 // FIXME: comment on what this really does
 bool blockReadingUART = false;
 
+// buzzer feedback while learning (milliseconds), kept below the watchdog timeout because delay1ms() blocks
+#define LEARN_START_BEEP_MS 50
+#define LEARN_OK_BEEP_MS    200
+#define LEARN_KO_BEEP_MS    500
+
+// the start beep is given by the main loop, so the UART state machine does not block for it
+static bool learn_start_beep = false;
+
 // sdcc manual section 3.8.1 general information
 // requires interrupt definition to appear or be included in main
 // sdccman sec. 3.8.1 indicates isr prototype must appear or be included in the file containing main
@@ -74,6 +83,10 @@ bool blockReadingUART = false;
     void timer2_isr(void) __interrupt (d_T2_Vector);
     // hardware uart
     void uart_isr(void)   __interrupt (d_UART0_Vector);
+#if PORTISCH_DEDUP_CACHE_SIZE > 0
+    // free running tick for the dedup cache
+    void timer0_isr(void) __interrupt (d_T0_Vector);
+#endif
 
 #elif defined(TARGET_BOARD_EFM8BB1) || defined(TARGET_BOARD_EFM8BB1LCB)
     // timer0 was used for PCA in portisch, instead just use system clock
@@ -82,6 +95,10 @@ bool blockReadingUART = false;
     // timer2 is used on demand to provide delays
     void timer2_isr(void) __interrupt (TIMER2_VECTOR);
     void pca0_isr(void) __interrupt (PCA0_VECTOR);
+#if PORTISCH_DEDUP_CACHE_SIZE > 0
+    // free running tick for the dedup cache
+    void timer0_isr(void) __interrupt (TIMER0_VECTOR);
+#endif
     // timer3 was previously used on demand to provide delays
     //void TIMER3_ISR(void) __interrupt (TIMER3_VECTOR);
 #else
@@ -95,6 +112,51 @@ bool blockReadingUART = false;
 // useful place to disable the watchdog timer, which is enable by default
 // and may trigger before main() in some instances.
 //-----------------------------------------------------------------------------
+static void learn_beep(const uint16_t milliseconds)
+{
+	buzzer_on();
+	delay1ms(milliseconds);
+	buzzer_off();
+}
+
+// 0xA1 learns a PT226x code like STANDARD sniffing, 0xA9 any enabled protocol like ADVANCED sniffing
+static void start_learn_mode(const rf_sniffing_mode_t mode)
+{
+	learn_start_beep = true;
+
+	sniffing_mode = mode;
+	PCA0_DoSniffing();
+	rf_state = RF_IDLE;
+
+	start_learning(PORTISCH_LEARN_REPEATS);
+
+	// learning gives up when the delay timer runs out
+	stop_delay_timer();
+	init_delay_timer_ms(1, PORTISCH_LEARN_TIMEOUT_MS);
+}
+
+// ends learning and sets the receiver up again for the sniffing that was running before,
+// for commands that replace learning (they set up the receiver themselves where they need to)
+static void cancel_learn_mode(void)
+{
+	learn_start_beep = false;
+
+	stop_learning();
+	stop_delay_timer();
+
+	sniffing_mode = (last_sniffing_command == RF_CODE_SNIFFING_ON) ? ADVANCED : STANDARD;
+	PCA0_DoSniffing();
+	rf_state = RF_IDLE;
+}
+
+// back to the sniffing that was running before learning
+static void stop_learn_mode(void)
+{
+	cancel_learn_mode();
+
+	uart_command = last_sniffing_command;
+}
+
 unsigned char __sdcc_external_startup(void)
 {
     // pg. 218, sec. 20.3 disable watchdog timer
@@ -163,13 +225,24 @@ void uart_state_machine(const unsigned int rxdata)
 
 		// sync byte got received, read command
 		case SYNC_INIT:
+			// any other command ends learning, otherwise decoding stays in learn mode and its timeout keeps running
+			if ((uart_command == RF_CODE_LEARN || uart_command == RF_CODE_LEARN_NEW) &&
+				(rxdata & 0xFF) != RF_CODE_LEARN && (rxdata & 0xFF) != RF_CODE_LEARN_NEW)
+			{
+				cancel_learn_mode();
+			}
+
 			uart_command = rxdata & 0xFF;
 			uart_state = SYNC_FINISH;
 
+			// commands may use RF_DATA[], so raw sniffing discards durations not sent yet
+			uart_start_RF_raw();
+
 			// check if some data needs to be received
 			switch(uart_command)
 			{
 				case RF_CODE_LEARN:
+					start_learn_mode(STANDARD);
 					break;
 				case RF_CODE_RFOUT:
 					// stop sniffing while handling received data
@@ -218,9 +291,16 @@ void uart_state_machine(const unsigned int rxdata)
 				case RF_CODE_SNIFFING_ON_BUCKET:
 					PCA0_DoSniffing();
 					last_sniffing_command = RF_CODE_SNIFFING_ON_BUCKET;
+					rf_state = RF_IDLE;
+					break;
+				case RF_CODE_SNIFFING_ON_RAW:
+					// no decoding, durations are streamed to the host
+					PCA0_DoSniffing();
+					last_sniffing_command = RF_CODE_SNIFFING_ON_RAW;
 					rf_state = RF_IDLE;
 					break;
 				case RF_CODE_LEARN_NEW:
+					start_learn_mode(ADVANCED);
 					break;
 				case RF_CODE_ACK:
                     // FIXME: I do not think this comment matches what happens in code, need to examine
@@ -232,6 +312,11 @@ void uart_state_machine(const unsigned int rxdata)
 					break;
                 case RF_RESET_MCU:
                     break;
+#if RF_STATS == 1
+				case RF_CODE_STATS:
+					// no further data is expected, reply is sent from main loop
+					break;
+#endif
 				// unknown command
 				default:
 					uart_command = NONE;
@@ -291,10 +376,12 @@ void uart_state_machine(const unsigned int rxdata)
 				switch(uart_command)
 				{
 					case RF_CODE_LEARN:
+					case RF_CODE_LEARN_NEW:
 					case RF_CODE_SNIFFING_ON:
 					case RF_CODE_SNIFFING_OFF:
 					case RF_CODE_RFIN:
 					case RF_CODE_SNIFFING_ON_BUCKET:
+					case RF_CODE_SNIFFING_ON_RAW:
 						// send acknowledge
 						uart_put_command(RF_CODE_ACK);
 					case RF_CODE_ACK:
@@ -508,9 +595,19 @@ void main (void)
     //FIXME: in rcswitch we did pca0_run() here, but it happens in DoSniffing() for portisch
 #endif
 
+#if CAPTURE_FREE_RUNNING == 1
+    // gaps are measured across overflows of the capture timer
+    enable_capture_overflow_interrupt();
+#endif
+
     // FIXME: this is slightly different to rcswitch initialization, need to decide what makes the most sense
     enable_capture_interrupt();
 
+#if PORTISCH_DEDUP_CACHE_SIZE > 0
+    // timer0 is otherwise unused by portisch on both boards
+    init_tick_timer();
+#endif
+
 
 	// start sniffing be default
 	// set desired sniffing type to PT2260
@@ -579,8 +676,10 @@ void main (void)
 
 #if 1
 		// check if something got received by UART
-		// only read data from uart if idle
-		if (!blockReadingUART)
+		// only read data from uart if idle and after a 0xB1 frame is completely queued,
+		// so that replies to commands are not placed in the middle of it
+		// (the frame is queued further first in any case, blockReadingUART only holds back commands)
+		if (!uart_continue_RF_buckets() && !blockReadingUART)
         {
 			rxdata = uart_getc();
 		} else {
@@ -621,6 +720,10 @@ void main (void)
 			
 				if (idleResetCount > 30000)
 				{
+					// a learn command without its end byte is dropped as well
+					if (uart_command == RF_CODE_LEARN || uart_command == RF_CODE_LEARN_NEW)
+						cancel_learn_mode();
+
 					idleResetCount = 0;
 					uart_state = IDLE;
 					uart_command = NONE;
@@ -672,11 +775,8 @@ void main (void)
 				}
 				else
 				{
-					// disable interrupt for radio receiving while reading buffer
-					disable_capture_interrupt();
+					// buffer is safe to read with the capture interrupt running, see buffer_in()
 					result = buffer_out(&bucket);
-					// FIXME: reenable (should store previous and just restore that?)
-					enable_capture_interrupt();
 
 					// handle new received buckets
 					if (result)
@@ -685,6 +785,57 @@ void main (void)
                     }
 				}
 				break;
+			// learn the next code received PORTISCH_LEARN_REPEATS times in a row
+			case RF_CODE_LEARN:
+			case RF_CODE_LEARN_NEW:
+
+				if (learn_start_beep)
+				{
+					learn_start_beep = false;
+					learn_beep(LEARN_START_BEEP_MS);
+				}
+
+				// check if a RF signal got decoded often enough
+				if ((RF_DATA_STATUS & RF_DATA_RECEIVED_MASK) != 0)
+				{
+					learn_beep(LEARN_OK_BEEP_MS);
+
+					if (uart_command == RF_CODE_LEARN)
+					{
+						// same as RF_CODE_RFIN, avoid writing to radio buffer while reading it
+						disable_capture_interrupt();
+						uart_put_RF_Data_Standard(RF_CODE_LEARN_OK);
+						enable_capture_interrupt();
+					}
+					else
+					{
+						uart_put_RF_Data_Advanced(RF_CODE_LEARN_OK_NEW, RF_DATA_STATUS & 0x7F);
+					}
+
+					// clear RF status
+					RF_DATA_STATUS = 0;
+
+					stop_learn_mode();
+				}
+				else if (is_delay_timer_finished())
+				{
+					learn_beep(LEARN_KO_BEEP_MS);
+
+					uart_put_command((uart_command == RF_CODE_LEARN) ? RF_CODE_LEARN_KO : RF_CODE_LEARN_KO_NEW);
+
+					stop_learn_mode();
+				}
+				else
+				{
+					// buffer is safe to read with the capture interrupt running, see buffer_in()
+					result = buffer_out(&bucket);
+
+					if (result)
+					{
+						HandleRFBucket(bucket & 0x7FFF, (bool)((bucket & 0x8000) >> 15));
+					}
+				}
+				break;
 			case RF_CODE_RFOUT:
 
 				// only do the job if all data got received by UART
@@ -842,17 +993,12 @@ void main (void)
 				// check if a RF signal got decoded
 				if ((RF_DATA_STATUS & RF_DATA_RECEIVED_MASK) != 0)
 				{
-					//
-					disable_capture_interrupt();
-					
-					//
+					// only starts sending, the rest of the frame is queued at the top of the main loop
+					// while decoding continues (the capture interrupt only writes to buffer_buckets[])
 					uart_put_RF_buckets(RF_CODE_SNIFFING_ON_BUCKET);
 
 					// clear RF status
 					RF_DATA_STATUS = 0;
-
-					// enable interrupt for RF receiving
-					enable_capture_interrupt();
 				}
 				else
 				{
@@ -866,6 +1012,10 @@ void main (void)
 
 			break;
 
+			case RF_CODE_SNIFFING_ON_RAW:
+				uart_stream_RF_raw(RF_CODE_SNIFFING_ON_RAW);
+				break;
+
 			// do a beep
 			case RF_DO_BEEP:
 				// only do the job if all data got received by UART
@@ -900,6 +1050,20 @@ void main (void)
                 reset_mcu();
 
                 break;
+#if RF_STATS == 1
+			// host was requesting the decode statistics
+			case RF_CODE_STATS:
+				// only do the job if the command was completed by UART
+				if (uart_state != IDLE)
+					break;
+
+				uart_put_RF_Stats(RF_CODE_STATS);
+
+				blockReadingUART = false;
+
+				uart_command = last_sniffing_command;
+				break;
+#endif
 			// host was requesting the firmware version
 			case RF_ALTERNATIVE_FIRMWARE:
 
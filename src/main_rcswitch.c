@@ -60,9 +60,18 @@
 // hardware specific
 #include "timer_interrupts.h"
 
+// load shedding during receiver noise
+#include "capture_gate.h"
+
+// durations from a free-running capture timer
+#include "capture_timer.h"
+
 // ring buffer supported
 #include "uart.h"
 
+// the software uart shares its pin with the receiver copy
+#include "rdata_mirror.h"
+
 
 // since the uart pins are used for communication with ESP8265
 // it is helpful to have serial output on another pin (e.g., reset pin)
@@ -219,7 +228,7 @@ int main (void)
     init_serial_interrupt();
     enable_serial_interrupt();
     
-#if 0
+#if SOFTWARE_UART == 1
     // software serial
     // default state is reset/pin1 high if using software uart as transmit pin
     soft_tx_pin_on();
@@ -270,6 +279,16 @@ int main (void)
 #endif
     
 
+#if CAPTURE_STORM_GATE == 1
+    // frames only start after a gap longer than the separation limit, so such a gap ends a noise storm
+    capture_gate_counts = US_TO_CAPTURE_COUNTS(N_SEPARATION_LIMIT_US);
+#endif
+
+#if CAPTURE_FREE_RUNNING == 1
+    // gaps are measured across overflows of the capture timer
+    enable_capture_overflow_interrupt();
+#endif
+
     // radio receiver edge detection
     enable_capture_interrupt();
     
@@ -335,12 +354,12 @@ int main (void)
         rf_state_machine(rfCommand);
             
 
+        // match a frame completed by the capture interrupt against known protocols
+        decode_frame();
+
+        // capture interrupt only records timings, so it does not need to be disabled here
         if (available())
         {
-            // FIXME: there must be a better way to lock
-            // disable interrupt is needed to avoid corrupting the currently received packet
-            disable_capture_interrupt();
-            
             // formatted for tasmota for output to web interface
             radio_rfin();
             
@@ -355,9 +374,6 @@ int main (void)
 
             // clears received data
             reset_available();
-            
-            // FIXME: if we use software uart to send debug output, this will be slow to be re-enabled
-            enable_capture_interrupt();
         }
         
         
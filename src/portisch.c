@@ -9,6 +9,9 @@
 //#include <stdlib.h>
 
 //#include "capture_interrupt.h"
+#include "capture_filter.h"
+#include "capture_gate.h"
+#include "capture_timer.h"
 #include "delay.h"
 #include "hal.h"
 #include "portisch.h"
@@ -17,8 +20,15 @@
 //#include "pca_0.h"
 //#include "timers.h"
 
-// FIXME: not clear why this is four as opposed to anything else
-#define BUFFER_BUCKETS_SIZE 4
+// edges between capture interrupt and main loop, see buffer_in()
+#define BUFFER_BUCKETS_SIZE PORTISCH_BUFFER_BUCKETS_SIZE
+#define BUFFER_BUCKETS_MASK (BUFFER_BUCKETS_SIZE - 1)
+
+// indices run freely through 0..255 and are masked on access,
+// the last entry is kept for the zero duration that resets the decoders (see buffer_in())
+#if (BUFFER_BUCKETS_SIZE & BUFFER_BUCKETS_MASK) != 0 || BUFFER_BUCKETS_SIZE < 2 || BUFFER_BUCKETS_SIZE > 128
+#error "PORTISCH_BUFFER_BUCKETS_SIZE must be a power of two from 2 up to 128"
+#endif
 
 // FIXME: add comment
 __xdata uint8_t RF_DATA[RF_DATA_BUFFERSIZE];
@@ -48,6 +58,28 @@ __xdata PROTOCOL_STATUS status[NUM_OF_PROTOCOLS];
 __xdata uint8_t old_crc = 0;
 __xdata uint8_t crc = 0;
 
+#if PORTISCH_DEDUP_CACHE_SIZE > 0
+// codes reported within the hold-off time, most recently reported first
+typedef struct DEDUP_ENTRY
+{
+	uint8_t protocol;
+	uint8_t crc;
+	uint16_t tick;
+} DEDUP_ENTRY;
+
+__xdata DEDUP_ENTRY dedup_cache[PORTISCH_DEDUP_CACHE_SIZE];
+__xdata uint8_t dedup_count = 0;
+#endif
+
+// protocol index of bucket sniffing codes for is_new_code()
+#define DEDUP_BUCKET_PROTOCOL 0xFF
+
+// while learning a code is only reported once it was received learn_repeats times in a row, 0 when not learning
+__xdata uint8_t learn_repeats = 0;
+__xdata uint8_t learn_count;
+__xdata uint8_t learn_protocol;
+__xdata uint8_t learn_crc;
+
 // up to 8 timing buckets for RF_CODE_SNIFFING_ON_BUCKET
 // -1 because of the bucket_sync
 __xdata uint16_t buckets[7];
@@ -57,14 +89,74 @@ __xdata uint16_t bucket_sync;
 __xdata uint8_t bucket_count = 0;
 __xdata uint8_t bucket_count_sync_1;
 __xdata uint8_t bucket_count_sync_2;
+// buckets[], RF_DATA[] and actual_byte of the last code are still being sent, so no new code is collected
+__xdata bool bucket_data_in_use = false;
 
 
+#if PORTISCH_SHARED_BUCKETS == 1
+// windows (exclusive limits) of distinct bucket durations of all protocols in ascending order, built by init_shared_buckets()
+__xdata uint16_t shared_lower[NUM_OF_PROTOCOL_BUCKETS];
+__xdata uint16_t shared_upper[NUM_OF_PROTOCOL_BUCKETS];
+__xdata uint8_t shared_bucket_count;
+// index into shared_lower[]/shared_upper[] for every protocol bucket, protocols follow each other as in PROTOCOL_DATA
+__xdata uint8_t shared_bucket_index[NUM_OF_PROTOCOL_BUCKETS];
+// shared buckets matching the current duration are duration_first up to (excluding) duration_last
+__xdata uint8_t duration_first;
+__xdata uint8_t duration_last;
+
+// a bucket which can never match, see init_shared_buckets()
+#define NO_SHARED_BUCKET 0xFF
+#endif
+
+#if PORTISCH_SYNC_MASKS == 1
+#if PORTISCH_SHARED_BUCKETS != 1
+#error "PORTISCH_SYNC_MASKS needs PORTISCH_SHARED_BUCKETS"
+#endif
+
+// bit i stands for protocol i of PROTOCOL_DATA
+#if NUM_OF_PROTOCOLS_ENABLED <= 8
+typedef uint8_t PROTOCOL_MASK;
+#elif NUM_OF_PROTOCOLS_ENABLED <= 16
+typedef uint16_t PROTOCOL_MASK;
+#elif NUM_OF_PROTOCOLS_ENABLED <= 32
+typedef uint32_t PROTOCOL_MASK;
+#else
+#error "PORTISCH_SYNC_MASKS supports up to 32 protocols"
+#endif
+
+// protocols waiting for their sync bucket at each position
+__xdata PROTOCOL_MASK sync_mask[PROTOCOL_MAX_START_SIZE];
+// protocols with finished sync, only these decode bits
+__xdata PROTOCOL_MASK decode_mask;
+
+// built by init_sync_masks(): protocols expecting a high sync bucket and protocols with sync finished after each position
+__xdata PROTOCOL_MASK sync_high_mask[PROTOCOL_MAX_START_SIZE];
+__xdata PROTOCOL_MASK sync_last_mask[PROTOCOL_MAX_START_SIZE];
+__xdata PROTOCOL_MASK sync_protocols_mask;
+// shared buckets used as sync bucket at each position in ascending order, with the protocols using them
+__xdata uint8_t sync_bucket[PROTOCOL_MAX_START_SIZE][NUM_OF_PROTOCOLS_ENABLED];
+__xdata PROTOCOL_MASK sync_bucket_protocols[PROTOCOL_MAX_START_SIZE][NUM_OF_PROTOCOLS_ENABLED];
+__xdata uint8_t sync_bucket_count[PROTOCOL_MAX_START_SIZE];
+#endif
+
 // stores measured durations temporarily
 __xdata uint16_t buffer_buckets[BUFFER_BUCKETS_SIZE] = {0};
 
-// use separate read and write "pointers" into circular buffer
-__xdata uint8_t buffer_buckets_read = 0;
-__xdata uint8_t buffer_buckets_write = 0;
+// single producer (capture interrupt), single consumer (main loop):
+// only buffer_in() writes buffer_buckets_write and only buffer_out() writes buffer_buckets_read,
+// both are 8 bit and so read and written in one access, no critical section is needed
+__xdata volatile uint8_t buffer_buckets_read = 0;
+__xdata volatile uint8_t buffer_buckets_write = 0;
+
+// durations dropped because the main loop did not keep up
+__xdata volatile uint16_t buffer_buckets_overflows = 0;
+// the same since raw sniffing last sent a packet, saturates at 0xFF
+__xdata volatile uint8_t buffer_buckets_dropped = 0;
+
+#if RF_STATS == 1
+__xdata RF_STATISTICS rf_stats;
+__xdata uint16_t rf_stats_decodes[NUM_OF_PROTOCOLS];
+#endif
 
 //-----------------------------------------------------------------------------
 // Callbacks
@@ -72,6 +164,48 @@ __xdata uint8_t buffer_buckets_write = 0;
 void PCA0_overflowCb(void) { }
 void PCA0_intermediateOverflowCb(void) { }
 
+#if PORTISCH_CRC8_TABLE == 2
+// crc of every byte value, generator 0x1D
+__code static const uint8_t crc8_table[256] = {
+	0x00, 0x1D, 0x3A, 0x27, 0x74, 0x69, 0x4E, 0x53, 0xE8, 0xF5, 0xD2, 0xCF, 0x9C, 0x81, 0xA6, 0xBB,
+	0xCD, 0xD0, 0xF7, 0xEA, 0xB9, 0xA4, 0x83, 0x9E, 0x25, 0x38, 0x1F, 0x02, 0x51, 0x4C, 0x6B, 0x76,
+	0x87, 0x9A, 0xBD, 0xA0, 0xF3, 0xEE, 0xC9, 0xD4, 0x6F, 0x72, 0x55, 0x48, 0x1B, 0x06, 0x21, 0x3C,
+	0x4A, 0x57, 0x70, 0x6D, 0x3E, 0x23, 0x04, 0x19, 0xA2, 0xBF, 0x98, 0x85, 0xD6, 0xCB, 0xEC, 0xF1,
+	0x13, 0x0E, 0x29, 0x34, 0x67, 0x7A, 0x5D, 0x40, 0xFB, 0xE6, 0xC1, 0xDC, 0x8F, 0x92, 0xB5, 0xA8,
+	0xDE, 0xC3, 0xE4, 0xF9, 0xAA, 0xB7, 0x90, 0x8D, 0x36, 0x2B, 0x0C, 0x11, 0x42, 0x5F, 0x78, 0x65,
+	0x94, 0x89, 0xAE, 0xB3, 0xE0, 0xFD, 0xDA, 0xC7, 0x7C, 0x61, 0x46, 0x5B, 0x08, 0x15, 0x32, 0x2F,
+	0x59, 0x44, 0x63, 0x7E, 0x2D, 0x30, 0x17, 0x0A, 0xB1, 0xAC, 0x8B, 0x96, 0xC5, 0xD8, 0xFF, 0xE2,
+	0x26, 0x3B, 0x1C, 0x01, 0x52, 0x4F, 0x68, 0x75, 0xCE, 0xD3, 0xF4, 0xE9, 0xBA, 0xA7, 0x80, 0x9D,
+	0xEB, 0xF6, 0xD1, 0xCC, 0x9F, 0x82, 0xA5, 0xB8, 0x03, 0x1E, 0x39, 0x24, 0x77, 0x6A, 0x4D, 0x50,
+	0xA1, 0xBC, 0x9B, 0x86, 0xD5, 0xC8, 0xEF, 0xF2, 0x49, 0x54, 0x73, 0x6E, 0x3D, 0x20, 0x07, 0x1A,
+	0x6C, 0x71, 0x56, 0x4B, 0x18, 0x05, 0x22, 0x3F, 0x84, 0x99, 0xBE, 0xA3, 0xF0, 0xED, 0xCA, 0xD7,
+	0x35, 0x28, 0x0F, 0x12, 0x41, 0x5C, 0x7B, 0x66, 0xDD, 0xC0, 0xE7, 0xFA, 0xA9, 0xB4, 0x93, 0x8E,
+	0xF8, 0xE5, 0xC2, 0xDF, 0x8C, 0x91, 0xB6, 0xAB, 0x10, 0x0D, 0x2A, 0x37, 0x64, 0x79, 0x5E, 0x43,
+	0xB2, 0xAF, 0x88, 0x95, 0xC6, 0xDB, 0xFC, 0xE1, 0x5A, 0x47, 0x60, 0x7D, 0x2E, 0x33, 0x14, 0x09,
+	0x7F, 0x62, 0x45, 0x58, 0x0B, 0x16, 0x31, 0x2C, 0x97, 0x8A, 0xAD, 0xB0, 0xE3, 0xFE, 0xD9, 0xC4
+};
+
+uint8_t Compute_CRC8_Simple_OneByte(uint8_t byteVal)
+{
+	return crc8_table[byteVal];
+}
+#elif PORTISCH_CRC8_TABLE == 1
+// crc of the upper nibble shifted through the register, i.e. four iterations of the loop below, generator 0x1D
+__code static const uint8_t crc8_nibble_table[16] = {
+	0x00, 0x1D, 0x3A, 0x27, 0x74, 0x69, 0x4E, 0x53, 0xE8, 0xF5, 0xD2, 0xCF, 0x9C, 0x81, 0xA6, 0xBB
+};
+
+uint8_t Compute_CRC8_Simple_OneByte(uint8_t byteVal)
+{
+	uint8_t crc = byteVal;
+
+	// the crc is linear, so the upper nibble can be shifted out in one step
+	crc = (uint8_t)(crc << 4) ^ crc8_nibble_table[crc >> 4];
+	crc = (uint8_t)(crc << 4) ^ crc8_nibble_table[crc >> 4];
+
+	return crc;
+}
+#else
 uint8_t Compute_CRC8_Simple_OneByte(uint8_t byteVal)
 {
     const uint8_t generator = 0x1D;
@@ -95,6 +229,91 @@ uint8_t Compute_CRC8_Simple_OneByte(uint8_t byteVal)
 
     return crc;
 }
+#endif
+
+// debounce, returns false if the code with the current crc was already reported within the hold-off time
+static bool is_new_code(uint8_t protocol)
+{
+#if PORTISCH_DEDUP_CACHE_SIZE > 0
+	uint16_t now = get_tick_count();
+	uint8_t i;
+
+	for (i = 0; i < dedup_count; i++)
+	{
+		// entries are ordered by age, so this and all following have expired
+		if ((uint16_t)(now - dedup_cache[i].tick) >= MS_TO_TICK_COUNT(PORTISCH_DEDUP_HOLDOFF_MS))
+		{
+			dedup_count = i;
+			break;
+		}
+
+		// reported recently, the hold-off is not extended so a held button repeats
+		if (dedup_cache[i].protocol == protocol && dedup_cache[i].crc == crc)
+			return false;
+	}
+
+	// new code becomes the first entry, the least recently reported code falls out when full
+	if (dedup_count < PORTISCH_DEDUP_CACHE_SIZE)
+		dedup_count++;
+
+#if PORTISCH_DEDUP_CACHE_SIZE > 1
+	for (i = dedup_count - 1; i > 0; i--)
+		dedup_cache[i] = dedup_cache[i - 1];
+#endif
+
+	dedup_cache[0].protocol = protocol;
+	dedup_cache[0].crc = crc;
+	dedup_cache[0].tick = now;
+
+	return true;
+#else
+	// a single code, the delay timer is shared with transmit
+	(void)protocol;
+
+	// check if timeout timer for crc is finished
+	if (is_delay_timer_finished())
+		old_crc = 0;
+
+	// check new crc on last received data for debounce
+	if (crc == old_crc)
+		return false;
+
+	// new data, restart crc timeout
+	stop_delay_timer();
+	init_delay_timer_ms(1, 800);
+	old_crc = crc;
+
+	return true;
+#endif
+}
+
+void start_learning(uint8_t repeats)
+{
+	learn_repeats = repeats;
+	learn_count = 0;
+}
+
+void stop_learning(void)
+{
+	learn_repeats = 0;
+}
+
+// counts identical codes in a row instead of debouncing them, reports the code once when learn_repeats is reached
+static bool is_stable_code(uint8_t protocol)
+{
+	if (learn_count != 0 && protocol == learn_protocol && crc == learn_crc)
+	{
+		learn_count++;
+	}
+	else
+	{
+		learn_protocol = protocol;
+		learn_crc = crc;
+		learn_count = 1;
+	}
+
+	return learn_count == learn_repeats;
+}
 
 uint16_t compute_delta(uint16_t bucket)
 {
@@ -115,7 +334,202 @@ bool CheckRFSyncBucket(uint16_t duration, uint16_t bucket)
 	return CheckRFBucket(duration, bucket, delta);
 }
 
-bool DecodeBucket(uint8_t i, bool high_low, uint16_t duration, uint16_t *pulses, uint8_t* bit0, uint8_t bit0_size, uint8_t* bit1, uint8_t bit1_size, uint8_t bit_count)
+#if PORTISCH_SHARED_BUCKETS == 1
+/*
+ * Windows of CheckRFSyncBucket() only grow with bucket length, so both window limits are ascending
+ * in shared_lower[] and shared_upper[] and the buckets matching a duration are one consecutive range.
+ * The table is built once at sniffing start, so every edge needs two short searches
+ * for all protocols together instead of one window computation per protocol.
+ */
+static uint16_t window_delta(uint16_t bucket)
+{
+	uint16_t delta = compute_delta(bucket);
+	delta = delta > TOLERANCE_MAX ? TOLERANCE_MAX : delta;
+	delta = delta < TOLERANCE_MIN ? TOLERANCE_MIN : delta;
+	return delta;
+}
+
+static void init_shared_buckets(void)
+{
+	uint8_t i;
+	uint8_t j;
+	uint8_t k;
+	uint8_t position = 0;
+	uint16_t bucket;
+	uint16_t upper;
+
+	shared_bucket_count = 0;
+
+	// insertion sort of distinct durations, upper limit is unique for every duration
+	for (i = 0; i < NUM_OF_PROTOCOLS; i++)
+	{
+		for (j = 0; j < PROTOCOL_DATA[i].buckets.size; j++)
+		{
+			bucket = PROTOCOL_DATA[i].buckets.dat[j];
+			upper = bucket + window_delta(bucket);
+
+			// lower window limit would wrap around, CheckRFSyncBucket() never matches these either
+			if (bucket < TOLERANCE_MIN || shared_bucket_count == NUM_OF_PROTOCOL_BUCKETS)
+				continue;
+
+			for (k = 0; k < shared_bucket_count && shared_upper[k] < upper; k++);
+
+			if (k < shared_bucket_count && shared_upper[k] == upper)
+				continue;
+
+			memmove(&shared_lower[k + 1], &shared_lower[k], (shared_bucket_count - k) * sizeof(shared_lower[0]));
+			memmove(&shared_upper[k + 1], &shared_upper[k], (shared_bucket_count - k) * sizeof(shared_upper[0]));
+			shared_lower[k] = bucket - window_delta(bucket);
+			shared_upper[k] = upper;
+			shared_bucket_count++;
+		}
+	}
+
+	// map every protocol bucket to its shared bucket
+	for (i = 0; i < NUM_OF_PROTOCOLS; i++)
+	{
+		for (j = 0; j < PROTOCOL_DATA[i].buckets.size && position < NUM_OF_PROTOCOL_BUCKETS; j++)
+		{
+			bucket = PROTOCOL_DATA[i].buckets.dat[j];
+			upper = bucket + window_delta(bucket);
+
+			for (k = 0; k < shared_bucket_count && shared_upper[k] != upper; k++);
+
+			shared_bucket_index[position++] = (bucket >= TOLERANCE_MIN && k < shared_bucket_count) ? k : NO_SHARED_BUCKET;
+		}
+	}
+}
+
+// find range of shared buckets matching the duration
+static void classify_duration(uint16_t duration)
+{
+	uint8_t low = 0;
+	uint8_t high = shared_bucket_count;
+	uint8_t middle;
+
+	// first bucket with upper window limit above duration
+	while (low < high)
+	{
+		middle = (low + high) >> 1;
+
+		if (shared_upper[middle] > duration)
+			high = middle;
+		else
+			low = middle + 1;
+	}
+
+	duration_first = low;
+
+	// windows overlap only a few neighbours, so walk to the first one with lower window limit not below duration
+	while (low < shared_bucket_count && shared_lower[low] < duration)
+		low++;
+
+	// range is empty if nothing matched
+	duration_last = low;
+}
+
+// bucket of protocol (or of pulses[] in STANDARD mode) matches duration
+static bool bucket_matches(uint16_t duration, uint16_t *pulses, __xdata uint8_t* shared_index, uint8_t bucket)
+{
+	uint8_t index;
+
+	if (shared_index != NULL)
+	{
+		index = shared_index[bucket];
+		return (index >= duration_first) && (index < duration_last);
+	}
+
+	return CheckRFSyncBucket(duration, pulses[bucket]);
+}
+#else
+#define bucket_matches(duration, pulses, shared_index, bucket) CheckRFSyncBucket((duration), (pulses)[(bucket)])
+#endif
+
+#if PORTISCH_SYNC_MASKS == 1
+/*
+ * Sync of all protocols is tracked like a NFA: sync_mask[n] holds the protocols
+ * which received n sync buckets, so one edge moves all of them with a few AND/OR.
+ * Only protocols in decode_mask get checked one by one by DecodeBucket().
+ * status[i].sync_status is start.size while protocol i decodes bits and 0 otherwise.
+ */
+static void reset_sync_masks(void)
+{
+	memset(sync_mask, 0, sizeof(sync_mask));
+	sync_mask[0] = sync_protocols_mask;
+	decode_mask = 0;
+}
+
+static void init_sync_masks(void)
+{
+	uint8_t i;
+	uint8_t j;
+	uint8_t k;
+	uint8_t index;
+	uint8_t position = 0;
+	PROTOCOL_MASK bit = 1;
+
+	memset(sync_high_mask, 0, sizeof(sync_high_mask));
+	memset(sync_last_mask, 0, sizeof(sync_last_mask));
+	memset(sync_bucket_count, 0, sizeof(sync_bucket_count));
+	sync_protocols_mask = 0;
+
+	for (i = 0; i < NUM_OF_PROTOCOLS; i++, bit <<= 1)
+	{
+		// protocols without sync or with a longer one than PROTOCOL_MAX_START_SIZE can not be tracked
+		if (PROTOCOL_DATA[i].start.size > 0 && PROTOCOL_DATA[i].start.size <= PROTOCOL_MAX_START_SIZE)
+		{
+			sync_protocols_mask |= bit;
+			sync_last_mask[PROTOCOL_DATA[i].start.size - 1] |= bit;
+
+			for (j = 0; j < PROTOCOL_DATA[i].start.size; j++)
+			{
+				if ((PROTOCOL_DATA[i].start.dat[j] & 0x08) != 0)
+					sync_high_mask[j] |= bit;
+
+				index = shared_bucket_index[position + (PROTOCOL_DATA[i].start.dat[j] & 0x07)];
+
+				if (index == NO_SHARED_BUCKET)
+					continue;
+
+				// insertion sort, protocols using the same shared bucket share one entry
+				for (k = 0; k < sync_bucket_count[j] && sync_bucket[j][k] < index; k++);
+
+				if (k == sync_bucket_count[j] || sync_bucket[j][k] != index)
+				{
+					memmove(&sync_bucket[j][k + 1], &sync_bucket[j][k], (sync_bucket_count[j] - k) * sizeof(sync_bucket[0][0]));
+					memmove(&sync_bucket_protocols[j][k + 1], &sync_bucket_protocols[j][k], (sync_bucket_count[j] - k) * sizeof(sync_bucket_protocols[0][0]));
+					sync_bucket[j][k] = index;
+					sync_bucket_protocols[j][k] = 0;
+					sync_bucket_count[j]++;
+				}
+
+				sync_bucket_protocols[j][k] |= bit;
+			}
+		}
+
+		position += PROTOCOL_DATA[i].buckets.size;
+	}
+
+	reset_sync_masks();
+}
+
+// protocols with sync bucket at position matching the last classified duration
+static PROTOCOL_MASK sync_matches(uint8_t position)
+{
+	PROTOCOL_MASK matches = 0;
+	uint8_t k = 0;
+
+	while (k < sync_bucket_count[position] && sync_bucket[position][k] < duration_first)
+		k++;
+
+	while (k < sync_bucket_count[position] && sync_bucket[position][k] < duration_last)
+		matches |= sync_bucket_protocols[position][k++];
+
+	return matches;
+}
+#endif
+
+bool DecodeBucket(uint8_t i, bool high_low, uint16_t duration, uint16_t *pulses, uint8_t* bit0, uint8_t bit0_size, uint8_t* bit1, uint8_t bit1_size, uint8_t bit_count, __xdata uint8_t* shared_index)
 {
 	uint8_t last_bit = 0;
 
@@ -130,7 +544,7 @@ bool DecodeBucket(uint8_t i, bool high_low, uint16_t duration, uint16_t *pulses,
 	// start decoding of the bits in sync of the buckets
 
 	// bit 0
-	if (CheckRFSyncBucket(duration, pulses[bit0[status[i].bit0_status] & 0x07]))
+	if (bucket_matches(duration, pulses, shared_index, bit0[status[i].bit0_status] & 0x07))
 	{
 		// decode only if high/low does match
 		if (((bit0[status[i].bit0_status] & 0x08) >> 3) == high_low)
@@ -148,7 +562,7 @@ bool DecodeBucket(uint8_t i, bool high_low, uint16_t duration, uint16_t *pulses,
 	}
 
 	// bit 1
-	if (CheckRFSyncBucket(duration, pulses[bit1[status[i].bit1_status] & 0x07]))
+	if (bucket_matches(duration, pulses, shared_index, bit1[status[i].bit1_status] & 0x07))
 	{
 		// decode only if high/low does match
 		if (((bit1[status[i].bit1_status] & 0x08) >> 3) == high_low)
@@ -222,20 +636,9 @@ bool DecodeBucket(uint8_t i, bool high_low, uint16_t duration, uint16_t *pulses,
 	// check if all bit got collected
 	if (status[i].bit_count >= bit_count)
 	{
-		// check if timeout timer for crc is finished
-		if (is_delay_timer_finished())
-		{
-			old_crc = 0;
-		}
-
-		// check new crc on last received data for debounce
-		if (crc != old_crc)
+		// check new crc on last received data for debounce, or for repeats while learning
+		if ((learn_repeats != 0) ? is_stable_code(i) : is_new_code(i))
 		{
-			// new data, restart crc timeout
-			stop_delay_timer();
-			init_delay_timer_ms(1, 800);
-			old_crc = crc;
-
 			// FIXME: it can be confusing to bury things like this in functions
 			// disable interrupt for RF receiving while uart transfer
 			//PCA0CPM0 &= ~PCA0CPM0_ECCF__ENABLED;
@@ -243,6 +646,12 @@ bool DecodeBucket(uint8_t i, bool high_low, uint16_t duration, uint16_t *pulses,
 			// set status
 			RF_DATA_STATUS = i;
 			RF_DATA_STATUS |= RF_DATA_RECEIVED_MASK;
+
+			STATS_INC(rf_stats_decodes[i]);
+		}
+		else
+		{
+			STATS_INC(rf_stats.debounced);
 		}
 
 		led_off();
@@ -260,13 +669,130 @@ bool DecodeBucket(uint8_t i, bool high_low, uint16_t duration, uint16_t *pulses,
 	return false;
 }
 
+#if PORTISCH_SYNC_MASKS == 1
+// ADVANCED decoding, same result as checking each protocol for each bucket
+static void HandleRFBucketMasks(uint16_t duration, bool high_low)
+{
+	PROTOCOL_MASK next_sync[PROTOCOL_MAX_START_SIZE];
+	PROTOCOL_MASK next_decode = 0;
+	PROTOCOL_MASK level;
+	PROTOCOL_MASK waiting;
+	PROTOCOL_MASK matched;
+	PROTOCOL_MASK remaining;
+	PROTOCOL_MASK bit;
+	// protocols after a completely decoded one are not checked on this bucket
+	PROTOCOL_MASK unchecked = 0;
+	__xdata uint8_t* shared_index = shared_bucket_index;
+	uint8_t i;
+
+	classify_duration(duration);
+
+	memset(next_sync, 0, sizeof(next_sync));
+
+	// sync: protocols expecting the other level keep their position,
+	// the others advance if the bucket matches or start over
+	for (i = 0; i < PROTOCOL_MAX_START_SIZE; i++)
+	{
+		level = high_low ? sync_high_mask[i] : (PROTOCOL_MASK)~sync_high_mask[i];
+		waiting = sync_mask[i] & level;
+		matched = 0;
+
+		if (waiting != 0 && duration_first != duration_last)
+			matched = waiting & sync_matches(i);
+
+		next_sync[i] |= sync_mask[i] & ~level;
+		next_sync[0] |= waiting & ~matched;
+		next_decode |= matched & sync_last_mask[i];
+
+		if (i + 1 < PROTOCOL_MAX_START_SIZE)
+			next_sync[i + 1] |= matched & ~sync_last_mask[i];
+	}
+
+	// bits: only protocols with finished sync, in the order of PROTOCOL_DATA
+	remaining = decode_mask;
+
+	for (i = 0, bit = 1; remaining != 0; i++, bit <<= 1)
+	{
+		if ((remaining & bit) != 0)
+		{
+			remaining &= ~bit;
+
+			if (DecodeBucket(i, high_low, duration, PROTOCOL_DATA[i].buckets.dat,PROTOCOL_DATA[i].bit0.dat, PROTOCOL_DATA[i].bit0.size,PROTOCOL_DATA[i].bit1.dat, PROTOCOL_DATA[i].bit1.size,PROTOCOL_DATA[i].bit_count, shared_index))
+				unchecked = ~((PROTOCOL_MASK)(bit << 1) - 1);
+
+			// DecodeBucket() restarts the protocol after a complete or a failed decoding
+			if (status[i].sync_status == 0)
+			{
+				decode_mask &= ~bit;
+				next_sync[0] |= bit;
+			}
+
+			if (unchecked != 0)
+				break;
+		}
+
+		shared_index += PROTOCOL_DATA[i].buckets.size;
+	}
+
+	for (i = 0; i < PROTOCOL_MAX_START_SIZE; i++)
+		sync_mask[i] = (next_sync[i] & ~unchecked) | (sync_mask[i] & unchecked);
+
+	next_decode &= ~unchecked;
+	decode_mask |= next_decode;
+
+	// protocols with just finished sync decode bits from the next bucket on
+	for (i = 0, bit = 1; next_decode != 0; i++, bit <<= 1)
+	{
+		if ((next_decode & bit) != 0)
+		{
+			next_decode &= ~bit;
+			status[i].sync_status = PROTOCOL_DATA[i].start.size;
+		}
+	}
+}
+#endif
+
+/*
+ * STANDARD mode takes the longer of the two durations of the first bit as long bucket, so PT226x clones
+ * with other ratios than 1:3 decode as well. The short bucket stays at sync / 31 when the shorter duration
+ * matches it, since a single pulse is more affected by jitter, otherwise it is the shorter duration.
+ * Only shifts are used to check the durations are plausible: long is 1.5 to 6 times short and sync 8 to 64 times short.
+ */
+static bool MeasureRFBitWidths(uint16_t high, uint16_t low)
+{
+	uint16_t pulse_short = high < low ? high : low;
+	uint16_t pulse_long  = high < low ? low : high;
+
+	if (pulse_long < pulse_short + (pulse_short >> 1) || pulse_long > (pulse_short << 2) + (pulse_short << 1))
+		return false;
+
+	if (pulse_short > (SYNC_LOW >> 3) || pulse_short <= (SYNC_LOW >> 6))
+		return false;
+
+	// sync / 31 of PT2260 without a divide, more accurate than a single pulse when it fits
+	buckets[0] = (SYNC_LOW >> 5) + (SYNC_LOW >> 10);
+
+	if (!CheckRFSyncBucket(pulse_short, buckets[0]))
+		buckets[0] = pulse_short;
+
+	buckets[1] = pulse_long;
+
+	return true;
+}
+
 void HandleRFBucket(uint16_t duration, bool high_low)
 {
 	uint8_t i = 0;
+	// buckets of the protocol being checked in shared_bucket_index[], NULL to check its own bucket durations
+	__xdata uint8_t* shared_index = NULL;
 
 	// if noise got received stop all running decodings
 	if (duration < MIN_BUCKET_LENGTH)
 	{
+		// zero durations are the noise resets of capture_handler(), counted there
+		if (duration != 0)
+			STATS_INC(rf_stats.short_rejects);
+
 		// compiler will optimize this out if NUM_OF_PROTOCOLS = 1
 		for (i = 0; i < NUM_OF_PROTOCOLS; i++)
 		{
@@ -278,6 +804,10 @@ void HandleRFBucket(uint16_t duration, bool high_low)
 			status[i].actual_bit_of_byte = 0;
 		}
 
+#if PORTISCH_SYNC_MASKS == 1
+		reset_sync_masks();
+#endif
+
 		led_off();
 		return;
 	}
@@ -289,7 +819,7 @@ void HandleRFBucket(uint16_t duration, bool high_low)
 			// check if protocol was not started
 			if (status[0].sync_status == 0)
 			{
-				// if PT226x standard sniffing calculate the pulse time by the longer sync bucket
+				// PT226x standard sniffing starts with the longer sync bucket, bit widths follow from the first bit
 				// this will enable receive PT226x in a range of PT226x_SYNC_MIN <-> 32767s
 				if (duration > PT226x_SYNC_MIN && !high_low) // && (duration < PT226x_SYNC_MAX))
 				{
@@ -299,25 +829,64 @@ void HandleRFBucket(uint16_t duration, bool high_low)
 					status[0].sync_status += 1;
 					status[0].sync_status += 1;
 					SYNC_LOW = duration;
-
-                    //FIXME: change to eliminate divide and multiply
-					buckets[0] = duration / 31;
-					buckets[1] = buckets[0] * 3;
 					buckets[2] = duration;
 				}
 			}
+			// first bit after sync, high part is kept until the low part tells which one is short
+			else if (status[0].sync_status == 2 && status[0].bit_count == 0 && status[0].bit0_status == 0 && status[0].bit1_status == 0)
+			{
+				if (high_low)
+				{
+					buckets[3] = duration;
+					status[0].sync_status = 3;
+				}
+				else
+				{
+					status[0].sync_status = 0;
+				}
+			}
+			else if (status[0].sync_status == 3)
+			{
+				if (!high_low && MeasureRFBitWidths(buckets[3], duration))
+				{
+					status[0].sync_status = 2;
+
+					// decode the first bit with the measured widths
+					DecodeBucket(0, true, buckets[3], buckets, PROTOCOL_DATA[0].bit0.dat, PROTOCOL_DATA[0].bit0.size, PROTOCOL_DATA[0].bit1.dat, PROTOCOL_DATA[0].bit1.size, PROTOCOL_DATA[0].bit_count, NULL);
+					DecodeBucket(0, false, duration, buckets, PROTOCOL_DATA[0].bit0.dat, PROTOCOL_DATA[0].bit0.size, PROTOCOL_DATA[0].bit1.dat, PROTOCOL_DATA[0].bit1.size, PROTOCOL_DATA[0].bit_count, NULL);
+				}
+				else
+				{
+					status[0].sync_status = 0;
+				}
+			}
 			// if sync is finished check if bit0 or bit1 is starting
 			else if (status[0].sync_status == 2)
 			{
 				// place all on one line so debugger does not get confused
-				DecodeBucket(0, high_low, duration, buckets, PROTOCOL_DATA[0].bit0.dat, PROTOCOL_DATA[0].bit0.size, PROTOCOL_DATA[0].bit1.dat, PROTOCOL_DATA[0].bit1.size, PROTOCOL_DATA[0].bit_count);
+				DecodeBucket(0, high_low, duration, buckets, PROTOCOL_DATA[0].bit0.dat, PROTOCOL_DATA[0].bit0.size, PROTOCOL_DATA[0].bit1.dat, PROTOCOL_DATA[0].bit1.size, PROTOCOL_DATA[0].bit_count, NULL);
 			}
 			break;
 
 		case ADVANCED:
+#if PORTISCH_SYNC_MASKS == 1
+			HandleRFBucketMasks(duration, high_low);
+#else
+#if PORTISCH_SHARED_BUCKETS == 1
+			// classify once, protocols look up their buckets in the result
+			classify_duration(duration);
+			shared_index = shared_bucket_index;
+#endif
+
 			// check each protocol for each bucket
 			for (i = 0; i < NUM_OF_PROTOCOLS; i++)
 			{
+#if PORTISCH_SHARED_BUCKETS == 1
+				// buckets of protocol i follow those of protocol i - 1
+				if (i > 0)
+					shared_index += PROTOCOL_DATA[i - 1].buckets.size;
+#endif
+
 				// protocol started, check if sync is finished
 				if (status[i].sync_status < PROTOCOL_DATA[i].start.size)
 				{
@@ -325,7 +894,7 @@ void HandleRFBucket(uint16_t duration, bool high_low)
 					if (((PROTOCOL_DATA[i].start.dat[status[i].sync_status] & 0x08) >> 3) != high_low)
 						continue;
 
-					if (CheckRFSyncBucket(duration, PROTOCOL_DATA[i].buckets.dat[PROTOCOL_DATA[i].start.dat[status[i].sync_status] & 0x07]))
+					if (bucket_matches(duration, PROTOCOL_DATA[i].buckets.dat, shared_index, PROTOCOL_DATA[i].start.dat[status[i].sync_status] & 0x07))
 					{
 						status[i].sync_status += 1;
 						continue;
@@ -344,59 +913,54 @@ void HandleRFBucket(uint16_t duration, bool high_low)
 				// if sync is finished check if bit0 or bit1 is starting
 				else if (status[i].sync_status == PROTOCOL_DATA[i].start.size)
 				{
-					if (DecodeBucket(i, high_low, duration, PROTOCOL_DATA[i].buckets.dat,PROTOCOL_DATA[i].bit0.dat, PROTOCOL_DATA[i].bit0.size,PROTOCOL_DATA[i].bit1.dat, PROTOCOL_DATA[i].bit1.size,PROTOCOL_DATA[i].bit_count))
+					if (DecodeBucket(i, high_low, duration, PROTOCOL_DATA[i].buckets.dat,PROTOCOL_DATA[i].bit0.dat, PROTOCOL_DATA[i].bit0.size,PROTOCOL_DATA[i].bit1.dat, PROTOCOL_DATA[i].bit1.size,PROTOCOL_DATA[i].bit_count, shared_index))
 						return;
 				}
 			}
+#endif
 			break;
 	}	// switch(sniffing_mode)
 }
 
 void buffer_in(uint16_t bucket)
 {
-	// check if writing next byte into circular buffer will catch up to read position, and if so bail out
-	if ((buffer_buckets_write + 1 == buffer_buckets_read) || (buffer_buckets_read == 0 && buffer_buckets_write + 1 == BUFFER_BUCKETS_SIZE))
+	// difference of the free running indices is the number of stored durations
+	const uint8_t stored = buffer_buckets_write - buffer_buckets_read;
+
+	// durations leave the last entry free so a reset (zero) always fits, only a reset can fill it,
+	// so a full buffer already ends with a reset and another one is not needed
+	if (bucket == 0 && stored >= BUFFER_BUCKETS_SIZE)
+		return;
+
+	if (bucket != 0 && stored >= BUFFER_BUCKETS_SIZE - 1)
 	{
+		if (buffer_buckets_overflows != 0xFFFF)
+			buffer_buckets_overflows++;
+
+		if (buffer_buckets_dropped != 0xFF)
+			buffer_buckets_dropped++;
+
 		return;
 	}
 
-	buffer_buckets[buffer_buckets_write] = bucket;
+	buffer_buckets[buffer_buckets_write & BUFFER_BUCKETS_MASK] = bucket;
 
+	// publish only after the duration is stored
 	buffer_buckets_write++;
-
-
-	if (buffer_buckets_write >= BUFFER_BUCKETS_SIZE)
-	{
-		buffer_buckets_write = 0;
-	}
 }
 
 bool buffer_out(uint16_t* bucket)
 {
-	//FIXME: may need to do this type of save outside of function call
-	//uint8_t backup_PCA0CPM0 = PCA0CPM0;
-
 	// check if buffer is empty
 	if (buffer_buckets_write == buffer_buckets_read)
 	{
 		return false;
 	}
 
-	// disable interrupt for RF receiving while reading buffer
-	//PCA0CPM0 &= ~PCA0CPM0_ECCF__ENABLED;
+	*bucket = buffer_buckets[buffer_buckets_read & BUFFER_BUCKETS_MASK];
 
-
-	*bucket = buffer_buckets[buffer_buckets_read];
+	// free the entry only after it is read
 	buffer_buckets_read++;
-
-
-	if (buffer_buckets_read >= BUFFER_BUCKETS_SIZE)
-	{
-		buffer_buckets_read = 0;
-	}
-
-	// reset register
-	//PCA0CPM0 = backup_PCA0CPM0;
 
 	return true;
 }
@@ -405,31 +969,94 @@ void capture_handler(uint16_t current_capture_value)
 {
     // makes code more readable
 	bool pin;
+#if CAPTURE_NATIVE_TICKS == 0
+	unsigned long duration_us;
+#endif
     
     //FIXME: possible to eliminate multiplication to save code size?
     //FIXME: make hardware abstraction
 	//uint16_t current_capture_value = get_capture_value();
     //current_capture_value = current_capture_value / 2;
-    // FIXME: this function expects a long type, so need to see if that matters or not
-    current_capture_value = countsToTime(current_capture_value);
 
+    // first, so that the time spent below is not lost from the next duration
     clear_pca_counter();
 
+	STATS_INC(rf_stats.edges);
+
+#if CAPTURE_GLITCH_FILTER == 1
+	// short pulses are merged into the duration before, so that one is only passed on now
+	if (!capture_filter(current_capture_value, !rdata_level()))
+		return;
+
+	current_capture_value = capture_filter_counts;
+#endif
+
+#if CAPTURE_NATIVE_TICKS == 0
+	// a gap of unknown length (see capture_timer.h) could convert to a bucket on EFM8BB1,
+	// and the longest durations need more than 16 bit in microseconds on OB38S003
+	if (current_capture_value != CAPTURE_GAP_COUNTS)
+	{
+		duration_us = countsToTime(current_capture_value);
+		current_capture_value = (duration_us > MAX_BUCKET_TICKS) ? CAPTURE_GAP_COUNTS : (uint16_t)duration_us;
+	}
+#endif
+
 	// FIXME: additional comments; if bucket is not noise add it to buffer
-	if (current_capture_value < 0x8000)
+	if (current_capture_value <= MAX_BUCKET_TICKS)
 	{
 		// FIXME: add comment
+#if CAPTURE_GLITCH_FILTER == 1
+		pin = !capture_filter_level;
+#else
 		pin = rdata_level();
+#endif
 		buffer_in(current_capture_value | ((uint16_t)(!pin) << 15));
 	}
 	else
 	{
-		// received noise, so clear all received buckets
-		buffer_buckets_read = 0;
-		buffer_buckets_write = 0;
+		// too long to be part of a frame, the read index belongs to the main loop
+		// so instead of clearing the buffer pass on a zero duration, which decoders treat as noise
+		buffer_in(0);
+
+		STATS_INC(rf_stats.noise);
 	}
 }
 
+#if CAPTURE_STORM_GATE == 1
+// shortest sync (longest bucket of a start sequence) of the enabled protocols less the sync tolerance
+// reopens the capture gate, it is used for every sniffing mode (see capture_gate.h)
+static void init_capture_gate(void)
+{
+	uint8_t i;
+	uint8_t j;
+	uint16_t bucket;
+	uint16_t sync;
+	uint16_t shortest = PT226x_SYNC_MIN;
+
+	for (i = 0; i < NUM_OF_PROTOCOLS; i++)
+	{
+		sync = 0;
+
+		for (j = 0; j < PROTOCOL_DATA[i].start.size; j++)
+		{
+			bucket = PROTOCOL_DATA[i].buckets.dat[PROTOCOL_DATA[i].start.dat[j] & 0x07];
+
+			if (bucket > sync)
+				sync = bucket;
+		}
+
+		// a protocol without start sequence keeps the gate open
+		if (sync < shortest)
+			shortest = sync;
+	}
+
+	shortest = (shortest > TOLERANCE_MAX) ? shortest - TOLERANCE_MAX : 0;
+
+	disable_capture_interrupt();
+	capture_gate_counts = US_TO_CAPTURE_COUNTS(TICKS_TO_US(shortest));
+}
+#endif
+
 uint8_t PCA0_DoSniffing(void)
 {
 	// FIXME:
@@ -438,6 +1065,19 @@ uint8_t PCA0_DoSniffing(void)
     // FIXME: possible to remove to save code size?
 	memset(status, 0, sizeof(PROTOCOL_STATUS) * NUM_OF_PROTOCOLS);
 
+#if PORTISCH_SHARED_BUCKETS == 1
+	init_shared_buckets();
+#endif
+
+#if PORTISCH_SYNC_MASKS == 1
+	init_sync_masks();
+#endif
+
+#if CAPTURE_STORM_GATE == 1
+	// capture interrupt is enabled again below
+	init_capture_gate();
+#endif
+
 	// restore timer to 100000Hz, 10s interval
 	//SetTimer0Overflow(0x0B);
 
@@ -604,7 +1244,18 @@ void SendBucketsByIndex(uint8_t index, uint8_t* rfdata)
 	uint8_t end_size   = PROTOCOL_DATA[index].end.size;
 	uint8_t bitcount   = PROTOCOL_DATA[index].bit_count;
     
+#if CAPTURE_NATIVE_TICKS == 1
+	uint8_t i;
+
+	// protocol buckets are capture counts but transmit timing is microseconds,
+	// receiving is stopped while transmitting so buckets[] is free to hold them
+	for (i = 0; i < PROTOCOL_DATA[index].buckets.size && i < ARRAY_LENGTH(buckets); i++)
+		buckets[i] = TICKS_TO_US(PROTOCOL_DATA[index].buckets.dat[i]);
+
+	SendBuckets(buckets, PROTOCOL_DATA[index].start.dat, start_size, PROTOCOL_DATA[index].bit0.dat, bit0_size, PROTOCOL_DATA[index].bit1.dat, bit1_size, PROTOCOL_DATA[index].end.dat, end_size, bitcount, rfdata);
+#else
 	SendBuckets(PROTOCOL_DATA[index].buckets.dat, PROTOCOL_DATA[index].start.dat, start_size, PROTOCOL_DATA[index].bit0.dat, bit0_size, PROTOCOL_DATA[index].bit1.dat, bit1_size, PROTOCOL_DATA[index].end.dat, end_size, bitcount, rfdata);
+#endif
 }
 
 
@@ -651,6 +1302,10 @@ void Bucket_Received(uint16_t duration, bool high_low)
 	// if pulse is too short reset status
 	if (duration < MIN_BUCKET_LENGTH)
 	{
+		// zero durations are the noise resets of capture_handler(), counted there
+		if (duration != 0)
+			STATS_INC(rf_stats.short_rejects);
+
 		rf_state = RF_IDLE;
 		return;
 	}
@@ -673,8 +1328,13 @@ void Bucket_Received(uint16_t duration, bool high_low)
 		case RF_BUCKET_REPEAT:
 			if (matchesFooter(duration, high_low))
 			{
+				// previous code is still being sent, so this sync only starts counting buckets again
+				if (bucket_data_in_use)
+				{
+					bucket_count_sync_1 = 0;
+				}
 				// check if a minimum of buckets where between two sync pulses
-				if (bucket_count_sync_1 > 4)
+				else if (bucket_count_sync_1 > 4)
 				{
 					led_on();
 					bucket_count = 0;
@@ -759,18 +1419,9 @@ void Bucket_Received(uint16_t duration, bool high_low)
 			// next bucket after data have to be a sync bucket
 			else if (matchesFooter(duration, high_low))
 			{
-				// check if timeout timer for crc is finished
-				if (is_delay_timer_finished())
-					old_crc = 0;
-
 				// check new crc on last received data for debounce
-				if (crc != old_crc)
+				if (is_new_code(DEDUP_BUCKET_PROTOCOL))
 				{
-					// new data, restart crc timeout
-					stop_delay_timer();
-					init_delay_timer_ms(1, 800);
-					old_crc = crc;
-
 					// disable interrupt for RF receiving while uart transfer
 					//FIXME: want to move outside of buried function
 					//PCA0CPM0 &= ~PCA0CPM0_ECCF__ENABLED;
@@ -782,6 +1433,12 @@ void Bucket_Received(uint16_t duration, bool high_low)
 					bucket_sync &= 0x7FFF;
 
 					RF_DATA_STATUS |= RF_DATA_RECEIVED_MASK;
+
+					STATS_INC(rf_stats.bucket_decodes);
+				}
+				else
+				{
+					STATS_INC(rf_stats.debounced);
 				}
 
 				led_off();
@@ -1,3 +1,4 @@
+#include "hal.h"
 #include "portisch.h"
 #include "portisch_command_format.h"
 #include "portisch_protocols.h"
@@ -8,19 +9,24 @@
 void uart_put_RF_Data_Standard(uint8_t command)
 {
 	uint8_t index = 0;
+	// timings are sent in microseconds regardless of CAPTURE_NATIVE_TICKS
+	uint16_t timing;
 
 	uart_putc(RF_CODE_START);
 	uart_putc(command);
 
 	// sync low time
-	uart_putc((SYNC_LOW >> 8) & 0xFF);
-	uart_putc(SYNC_LOW & 0xFF);
+	timing = TICKS_TO_US(SYNC_LOW);
+	uart_putc((timing >> 8) & 0xFF);
+	uart_putc(timing & 0xFF);
 	// bit 0 high time
-	uart_putc((BIT_LOW >> 8) & 0xFF);
-	uart_putc(BIT_LOW & 0xFF);
+	timing = TICKS_TO_US(BIT_LOW);
+	uart_putc((timing >> 8) & 0xFF);
+	uart_putc(timing & 0xFF);
 	// bit 1 high time
-	uart_putc((BIT_HIGH >> 8) & 0xFF);
-	uart_putc(BIT_HIGH & 0xFF);
+	timing = TICKS_TO_US(BIT_HIGH);
+	uart_putc((timing >> 8) & 0xFF);
+	uart_putc(timing & 0xFF);
 
 	// copy data to UART buffer
 	index = 0;
@@ -72,77 +78,262 @@ void uart_put_RF_Data_Advanced(uint8_t command, uint8_t protocol_index)
 
 
 
-// for bucket sniffing
-// a state machine might be ideal for this eventually
-// but unclear if it is really necessary
+// 0xB1 frame being queued by uart_continue_RF_buckets(), the transmit buffer cannot hold a whole frame
+// (position of the next byte in the frame and frame length, 0 when idle)
+static __xdata uint8_t bucket_tx_command;
+static __xdata uint8_t bucket_tx_position;
+static __xdata uint8_t bucket_tx_length = 0;
+// bucket decoding may look for the next sync meanwhile, which changes bucket_sync
+static __xdata uint16_t bucket_tx_sync;
+
+// byte at position of the frame AA <command> <bucket count + 1> <buckets> <sync bucket> <RF_DATA> 55
+static uint8_t bucket_frame_byte(uint8_t position)
+{
+	// timings are sent in microseconds regardless of CAPTURE_NATIVE_TICKS
+	uint16_t timing;
+
+	if (position == 0)
+		return RF_CODE_START;
+
+	if (position == 1)
+		return bucket_tx_command;
+
+	if (position == 2)
+		return bucket_count + 1;
+
+	position -= 3;
+
+	// up to 7 buckets followed by the sync bucket, two bytes each
+	if (position < ((bucket_count + 1) << 1))
+	{
+		if ((position >> 1) < bucket_count)
+			timing = TICKS_TO_US(buckets[position >> 1] & 0x7FFF);
+		else
+			timing = TICKS_TO_US(bucket_tx_sync & 0x7FFF);
+
+		if ((position & 0x01) == 0)
+			return (timing >> 8) & 0x7F;
+
+		return timing & 0xFF;
+	}
+
+	position -= (bucket_count + 1) << 1;
+
+	if (position < actual_byte)
+		return RF_DATA[position];
+
+	return RF_CODE_STOP;
+}
+
+// for bucket sniffing, queues as much of the frame as fits and leaves the rest to uart_continue_RF_buckets()
+// buckets[] and RF_DATA[] are kept by the decoder until the frame is queued, see bucket_data_in_use
 void uart_put_RF_buckets(uint8_t command)
+{
+	bucket_tx_command  = command;
+	bucket_tx_sync     = bucket_sync;
+	bucket_tx_position = 0;
+	bucket_tx_length   = 3 + ((bucket_count + 1) << 1) + actual_byte + 1;
+
+	bucket_data_in_use = true;
+
+	uart_continue_RF_buckets();
+}
+
+// called from the main loop, returns true while the frame is not completely queued
+bool uart_continue_RF_buckets(void)
+{
+	if (bucket_tx_length == 0)
+		return false;
+
+	while (bucket_tx_position < bucket_tx_length && uart_tx_free() != 0)
+	{
+		uart_putc(bucket_frame_byte(bucket_tx_position));
+		bucket_tx_position++;
+	}
+
+	if (bucket_tx_position < bucket_tx_length)
+		return true;
+
+	bucket_tx_length = 0;
+	bucket_data_in_use = false;
+
+	return false;
+}
+
+// raw sniffing packet AA <command> <length> <dropped> <durations> 55, length counts dropped and the durations
+// durations are collected in RF_DATA[], which no decoder uses meanwhile
+// the whole packet fits into the transmit buffer so it is queued at once and replies to commands never split it
+#define RAW_PACKET_SIZE     (UART_TX_BUFFER_SIZE - 5)
+// a 15 bit duration takes up to 3 bytes (6 + 7 + 7 bits) at any PORTISCH_RAW_SHIFT, 2 bytes hold up to 8191 units
+#define RAW_DURATION_BYTES  3
+
+static __xdata uint8_t raw_length = 0;
+
+// durations are sent in units of 2^PORTISCH_RAW_SHIFT microseconds, least significant bits first:
+// first byte:  bit 7 level (1 high), bit 6 more bytes follow, bits 5..0 duration
+// next bytes:  bit 7 more bytes follow, bits 6..0 duration
+// a single 0x00 marks a gap too long to be measured, durations shorter than one unit are sent as one unit
+// durations are at most 0x7FFF us (see MAX_BUCKET_TICKS), longer ones are saturated so they never need a 4th byte
+static void raw_put_duration(uint16_t bucket)
+{
+	uint16_t units = TICKS_TO_US(bucket & 0x7FFF);
+	uint8_t b;
+	uint8_t more = 0x40;
+
+	if (units > 0x7FFF)
+		units = 0x7FFF;
+
+	units >>= PORTISCH_RAW_SHIFT;
+
+	if (units == 0 && (bucket & 0x7FFF) != 0)
+		units = 1;
+
+	b = ((bucket >> 8) & 0x80) | (units & 0x3F);
+	units >>= 6;
+
+	while (units != 0)
+	{
+		RF_DATA[raw_length] = b | more;
+		raw_length++;
+
+		b = units & 0x7F;
+		units >>= 7;
+		more = 0x80;
+	}
+
+	RF_DATA[raw_length] = b;
+	raw_length++;
+}
+
+static void raw_put_packet(uint8_t command)
 {
 	uint8_t index = 0;
+	uint8_t dropped;
+
+	// wait until the whole packet fits
+	if (uart_tx_free() < raw_length + 5)
+		return;
+
+	disable_global_interrupts();
+	dropped = buffer_buckets_dropped;
+	buffer_buckets_dropped = 0;
+	enable_global_interrupts();
 
 	uart_putc(RF_CODE_START);
 	uart_putc(command);
-    
-	// put bucket count + sync bucket
-	uart_putc(bucket_count + 1);
-
-	// because the sniffing command (0xB1) can transmit a significant amount of bytes
-    // and we do not have so much ram to allocate as a buffer
-    // we normally check for buffer bytes to transmit by uart in the main loop
-    // but there is potentially so much data here that we would overflow prior to returning to main loop
-    // so just send in pieces instead
-
-    while(!is_uart_tx_buffer_empty())
-    {
-        if (is_uart_tx_finished())
-        {
-            // if not empty, set TI, which triggers interrupt to actually transmit
-            uart_init_tx_polling();
-        }
-    }
-
-	// send up to 7 buckets
-	while (index < bucket_count)
+	uart_putc(raw_length + 1);
+	uart_putc(dropped);
+
+	while (index < raw_length)
 	{
-		uart_putc((buckets[index] >> 8) & 0x7F);
-		uart_putc(buckets[index] & 0xFF);
+		uart_putc(RF_DATA[index]);
 		index++;
 	}
 
-	// send sync bucket
-	uart_putc((bucket_sync >> 8) & 0x7F);
-	uart_putc(bucket_sync & 0xFF);
+	uart_putc(RF_CODE_STOP);
 
-	// start and wait for transmit
-    while(!is_uart_tx_buffer_empty())
-    {
-        if (is_uart_tx_finished())
-        {
-            uart_init_tx_polling();
-        }
-    }
+	raw_length = 0;
+}
 
-	index = 0;
-    
-	while(index < actual_byte)
+// forgets durations not sent yet, a new raw sniffing packet starts without dropped edges
+void uart_start_RF_raw(void)
+{
+	raw_length = 0;
+
+	disable_global_interrupts();
+	buffer_buckets_dropped = 0;
+	enable_global_interrupts();
+}
+
+// called from the main loop for raw sniffing, handles at most one duration per call
+// durations are only taken from buffer_buckets[] while the packet has room, so when the uart cannot keep up
+// the capture interrupt drops edges and the next packet reports how many (saturating at 255)
+// packets are sent when full or, to keep latency low, as soon as the transmit buffer is empty
+void uart_stream_RF_raw(uint8_t command)
+{
+	uint16_t bucket;
+
+	if (raw_length > RAW_PACKET_SIZE - RAW_DURATION_BYTES)
 	{
-		uart_putc(RF_DATA[index]);
+		raw_put_packet(command);
+	}
+	else if (buffer_out(&bucket))
+	{
+		raw_put_duration(bucket);
+	}
+	else if (raw_length != 0 && is_uart_tx_buffer_empty())
+	{
+		raw_put_packet(command);
+	}
+}
+
+#if RF_STATS == 1
+// start and wait for transmit, the statistics do not fit into the transmit buffer at once
+static void uart_flush_tx(void)
+{
+	while(!is_uart_tx_buffer_empty())
+	{
+		if (is_uart_tx_finished())
+		{
+			uart_init_tx_polling();
+		}
+	}
+}
+
+static void uart_put_counter(uint16_t value)
+{
+	uart_putc((value >> 8) & 0xFF);
+	uart_putc(value & 0xFF);
+}
+
+// counters written by interrupts are 16 bit, so copy them with interrupts disabled
+static void uart_put_interrupt_counter(__xdata volatile uint16_t* counter)
+{
+	uint16_t value;
+
+	disable_global_interrupts();
+	value = *counter;
+	enable_global_interrupts();
+
+	uart_put_counter(value);
+}
+
+// reply to RF_CODE_STATS, see rf_stats.h
+// AA D0 len edges overflows noise short debounced uart_rx uart_tx bucket_decodes decodes[0..NUM_OF_PROTOCOLS-1] 55
+// every counter is 16 bit, most significant byte first
+void uart_put_RF_Stats(uint8_t command)
+{
+	uint8_t index = 0;
+	// sent before this reply is queued so that it does not count itself
+	uint16_t tx_bytes = uart_tx_bytes;
+
+	uart_putc(RF_CODE_START);
+	uart_putc(command);
+	uart_putc((8 + NUM_OF_PROTOCOLS) * 2);
+
+	uart_put_interrupt_counter(&rf_stats.edges);
+	uart_put_interrupt_counter(&buffer_buckets_overflows);
+	uart_put_interrupt_counter(&rf_stats.noise);
+	uart_put_counter(rf_stats.short_rejects);
+	uart_put_counter(rf_stats.debounced);
+	uart_put_interrupt_counter(&uart_rx_bytes);
+	uart_put_counter(tx_bytes);
+	uart_put_counter(rf_stats.bucket_decodes);
+
+	uart_flush_tx();
+
+	while (index < NUM_OF_PROTOCOLS)
+	{
+		uart_put_counter(rf_stats_decodes[index]);
 		index++;
 
-		// be safe so as to avoid buffer overflow
-        // FIXME: could modulo divide be worked into ring buffer logic itself?
-		if ((index % UART_TX_BUFFER_SIZE) == 0)
+		// send 16 bytes at a time to avoid buffer overflow
+		if ((index % 8) == 0)
 		{
-			// start and wait for transmit
-            while(!is_uart_tx_buffer_empty())
-            {
-                if (is_uart_tx_finished())
-                {
-                    uart_init_tx_polling();
-                }
-            }
+			uart_flush_tx();
 		}
 	}
 
 	uart_putc(RF_CODE_STOP);
-
-}
\ No newline at end of file
+}
+#endif
@@ -3,6 +3,8 @@
 #include <string.h>
 
 
+#include "capture_filter.h"
+#include "capture_timer.h"
 #include "delay.h"
 #include "hal.h"
 #include "rcswitch.h"
@@ -14,15 +16,52 @@
 //#include "ticks.h"
 
 
-// store measured pulse times for comparison to known protocol timings
-volatile __xdata uint16_t timings[RCSWITCH_MAX_CHANGES];
+// store measured pulse times for comparison to known protocol timings, see RCSWITCH_TIMING_SHIFT
+// used as a ring so that the capture interrupt keeps recording while the main loop decodes a completed frame
+volatile __xdata uint8_t timings[RCSWITCH_MAX_CHANGES];
+
+// largest duration timings[] can hold
+#if RCSWITCH_LOG_TIMINGS == 1
+#define MAX_COMPACT_TIMING (4032UL << RCSWITCH_LOG_SHIFT)
+#else
+#define MAX_COMPACT_TIMING (0xFFUL << RCSWITCH_TIMING_SHIFT)
+#endif
+
+// completed frame handed from capture interrupt to decode_frame()
+// (ring index of the gap preceding the frame, the gap itself and number of recorded durations including the gap)
+static volatile uint8_t frameStart;
+static volatile uint16_t frameGap;
+static volatile uint8_t frameChanges;
+static volatile bool    framePending = false;
+// ring slots the capture interrupt may still write before the pending frame is recorded over
+static volatile uint8_t frameSlack;
+static volatile bool    frameOverwritten;
 
 // we changed some ints to uint8_t so that printing over software uart was reasonable
 // would we ever have more than 256 protocols or bit length anyway ?
-unsigned long      nReceivedValue;
+__xdata uint8_t    nReceivedData[RCSWITCH_MAX_DATA_BYTES];
+// receive_protocol() decodes here, decode_frame() only accepts the result into the variables below
+// once the whole frame matched and its durations were not recorded over meanwhile
+static __xdata uint8_t decodedData[RCSWITCH_MAX_DATA_BYTES];
+static uint8_t     decodedBitlength;
+static uint16_t    decodedDelay;
+static uint16_t    decodedSync;
+static uint16_t    decodedShort;
+static uint16_t    decodedLong;
+// zero while nothing is received
 uint8_t            nReceivedBitlength;
 uint16_t           nReceivedDelay;
 uint8_t            nReceivedProtocol;
+uint16_t           nReceivedSync;
+
+// measured timings averaged over the frames of the code received last, instead of nominal multiples of the delay
+// (averaging restarts when a different code or sync is received, later repeats get less weight once MAX_AVERAGED_FRAMES is reached)
+#define MAX_AVERAGED_FRAMES 16
+uint16_t           nAverageSync;
+uint16_t           nAverageShort;
+uint16_t           nAverageLong;
+uint8_t            nAveragedFrames;
+uint8_t            nAveragedBitlength;
 
 const uint8_t nRepeatTransmit = 8;
 
@@ -30,21 +69,77 @@ const int nReceiveTolerance = N_RECEIVE_TOLERANCE;
 const unsigned int nSeparationLimit = N_SEPARATION_LIMIT;
 
 // pulse length is units of 10 microseconds, modified from the microsecond version because it is unreasonable to generate microsecond timing on these microcontrollers
+// the list is expanded into protocols[] and into the sync ratio index below, so both always agree
+// X(arg, number, pulse length, sync high, sync low, zero high, zero low, one high, one low, inverted)
+#define RCSWITCH_PROTOCOLS(X, arg) \
+  X(arg,  1, 350,   1,  31,   1,  3,   3,  1, false)  /* protocol 1 */                                              \
+  X(arg,  2, 650,   1,  10,   1,  2,   2,  1, false)  /* protocol 2 */                                              \
+  X(arg,  3, 100,  30,  71,   4, 11,   9,  6, false)  /* protocol 3 */                                              \
+  X(arg,  4, 380,   1,   6,   1,  3,   3,  1, false)  /* protocol 4 */                                              \
+  X(arg,  5, 500,   6,  14,   1,  2,   2,  1, false)  /* protocol 5 */                                              \
+  X(arg,  6, 450,  23,   1,   1,  2,   2,  1, true)   /* protocol 6 (HT6P20B) */                                    \
+  X(arg,  7, 150,   2,  62,   1,  6,   6,  1, false)  /* protocol 7 (HS2303-PT, i. e. used in AUKEY Remote) */      \
+  X(arg,  8, 200,   3, 130,   7, 16,   3, 16, false)  /* protocol 8 Conrad RS-200 RX */                             \
+  X(arg,  9, 200, 130,   7,  16,  7,  16,  3, true)   /* protocol 9 Conrad RS-200 TX */                             \
+  X(arg, 10, 365,  18,   1,   3,  1,   1,  3, true)   /* protocol 10 (1ByOne Doorbell) */                           \
+  X(arg, 11, 270,  36,   1,   1,  2,   2,  1, true)   /* protocol 11 (HT12E) */                                     \
+  X(arg, 12, 320,  36,   1,   1,  2,   2,  1, true)   /* protocol 12 (SM5212) */
+
+#define PROTOCOL_ENTRY(arg, number, pulseLength, syncHigh, syncLow, zeroHigh, zeroLow, oneHigh, oneLow, inverted) \
+  { pulseLength, { syncHigh, syncLow }, { zeroHigh, zeroLow }, { oneHigh, oneLow }, inverted },
+
 const struct Protocol protocols[] = {
-  { 350, {  1, 31 }, {  1,  3 }, {  3,  1 }, false },    // protocol 1
-  { 650, {  1, 10 }, {  1,  2 }, {  2,  1 }, false },    // protocol 2
-  { 100, { 30, 71 }, {  4, 11 }, {  9,  6 }, false },    // protocol 3
-  { 380, {  1,  6 }, {  1,  3 }, {  3,  1 }, false },    // protocol 4
-  { 500, {  6, 14 }, {  1,  2 }, {  2,  1 }, false },    // protocol 5
-  { 450, { 23,  1 }, {  1,  2 }, {  2,  1 }, true },     // protocol 6 (HT6P20B)
-  { 150, {  2, 62 }, {  1,  6 }, {  6,  1 }, false },    // protocol 7 (HS2303-PT, i. e. used in AUKEY Remote)
-  { 200, {  3, 130}, {  7, 16 }, {  3,  16}, false},     // protocol 8 Conrad RS-200 RX
-  { 200, { 130, 7 }, {  16, 7 }, { 16,  3 }, true},      // protocol 9 Conrad RS-200 TX
-  { 365, { 18,  1 }, {  3,  1 }, {  1,  3 }, true },     // protocol 10 (1ByOne Doorbell)
-  { 270, { 36,  1 }, {  1,  2 }, {  2,  1 }, true },     // protocol 11 (HT12E)
-  { 320, { 36,  1 }, {  1,  2 }, {  2,  1 }, true }      // protocol 12 (SM5212)
+  RCSWITCH_PROTOCOLS(PROTOCOL_ENTRY, 0)
+};
+
+/*
+ * Sync ratio index
+ *
+ * A frame starts with the long part of the sync (timings[0]) and receive_protocol() only accepts it if the first data
+ * duration is within tolerance of delay * zero.high or delay * one.high, where delay = sync / syncLengthInPulses.
+ * So the ratio of first data duration to sync already rules out most protocols.
+ * The ratio is quantized into RATIO_BINS bins and each bin holds a bitmask of protocols whose windows overlap it
+ * (widened by RATIO_MARGIN bins for integer rounding), so only those protocols are tried.
+ * Bit n - 1 is protocol n, so at most 16 protocols are supported.
+ */
+#define RATIO_BINS   64
+#define RATIO_MARGIN 2
+
+#define SYNC_LENGTH(syncHigh, syncLow) (((syncHigh) > (syncLow)) ? (syncHigh) : (syncLow))
+
+// ratio (factor +/- tolerance) / syncLength overlaps [bin, bin + 1) / RATIO_BINS
+#define RATIO_IN_WINDOW(bin, syncLength, factor) \
+  (((bin) - RATIO_MARGIN) * 100L * (syncLength) < ((factor) * 100L + N_RECEIVE_TOLERANCE) * RATIO_BINS && \
+   ((bin) + 1 + RATIO_MARGIN) * 100L * (syncLength) > ((factor) * 100L - N_RECEIVE_TOLERANCE) * RATIO_BINS)
+
+#define RATIO_CANDIDATE(bin, number, pulseLength, syncHigh, syncLow, zeroHigh, zeroLow, oneHigh, oneLow, inverted) \
+  | ((RATIO_IN_WINDOW(bin, SYNC_LENGTH(syncHigh, syncLow), zeroHigh) || \
+      RATIO_IN_WINDOW(bin, SYNC_LENGTH(syncHigh, syncLow), oneHigh)) ? (1u << ((number) - 1)) : 0)
+
+#define RATIO_ROW(bin) (0 RCSWITCH_PROTOCOLS(RATIO_CANDIDATE, bin))
+
+#define INVERTED_BIT(arg, number, pulseLength, syncHigh, syncLow, zeroHigh, zeroLow, oneHigh, oneLow, inverted) \
+  | ((inverted) ? (1u << ((number) - 1)) : 0)
+
+// data of inverted protocols starts one duration later, see receive_protocol()
+#define INVERTED_PROTOCOLS (0 RCSWITCH_PROTOCOLS(INVERTED_BIT, 0))
+
+__code static const uint16_t ratioCandidates[RATIO_BINS] = {
+  RATIO_ROW( 0), RATIO_ROW( 1), RATIO_ROW( 2), RATIO_ROW( 3), RATIO_ROW( 4), RATIO_ROW( 5), RATIO_ROW( 6), RATIO_ROW( 7),
+  RATIO_ROW( 8), RATIO_ROW( 9), RATIO_ROW(10), RATIO_ROW(11), RATIO_ROW(12), RATIO_ROW(13), RATIO_ROW(14), RATIO_ROW(15),
+  RATIO_ROW(16), RATIO_ROW(17), RATIO_ROW(18), RATIO_ROW(19), RATIO_ROW(20), RATIO_ROW(21), RATIO_ROW(22), RATIO_ROW(23),
+  RATIO_ROW(24), RATIO_ROW(25), RATIO_ROW(26), RATIO_ROW(27), RATIO_ROW(28), RATIO_ROW(29), RATIO_ROW(30), RATIO_ROW(31),
+  RATIO_ROW(32), RATIO_ROW(33), RATIO_ROW(34), RATIO_ROW(35), RATIO_ROW(36), RATIO_ROW(37), RATIO_ROW(38), RATIO_ROW(39),
+  RATIO_ROW(40), RATIO_ROW(41), RATIO_ROW(42), RATIO_ROW(43), RATIO_ROW(44), RATIO_ROW(45), RATIO_ROW(46), RATIO_ROW(47),
+  RATIO_ROW(48), RATIO_ROW(49), RATIO_ROW(50), RATIO_ROW(51), RATIO_ROW(52), RATIO_ROW(53), RATIO_ROW(54), RATIO_ROW(55),
+  RATIO_ROW(56), RATIO_ROW(57), RATIO_ROW(58), RATIO_ROW(59), RATIO_ROW(60), RATIO_ROW(61), RATIO_ROW(62), RATIO_ROW(63)
 };
 
+#if defined(RCSWITCH_COUNT_CALLS)
+// host builds count how many receive_protocol() calls the ratio index saves
+unsigned long rcswitchProtocolCalls = 0;
+unsigned long rcswitchProtocolCallsAvoided = 0;
+#endif
 
 // count of number of protocol entries
 const unsigned int numProto = sizeof(protocols) / sizeof(protocols[0]);
@@ -54,18 +149,18 @@ const unsigned int numProto = sizeof(protocols) / sizeof(protocols[0]);
 
 bool available(void)
 {
-    return nReceivedValue != 0;
+    return nReceivedBitlength != 0;
 }
 
 void reset_available(void)
 {
-    nReceivedValue = 0;
+    nReceivedBitlength = 0;
 }
 
 
-unsigned long get_received_value(void)
+uint8_t* get_received_data(void)
 {
-    return nReceivedValue;
+    return nReceivedData;
 }
 
 uint8_t get_received_bitlength(void)
@@ -73,6 +168,11 @@ uint8_t get_received_bitlength(void)
     return nReceivedBitlength;
 }
 
+uint8_t get_received_bytelength(void)
+{
+    return (nReceivedBitlength + 7) / 8;
+}
+
 uint16_t get_received_delay(void)
 {
     return nReceivedDelay;
@@ -88,22 +188,145 @@ int get_received_tolerance(void)
     return nReceiveTolerance;
 }
 
+uint16_t get_received_sync(void)
+{
+    return nReceivedSync;
+}
+
+uint16_t get_average_sync(void)
+{
+    return nAverageSync;
+}
+
+uint16_t get_average_short(void)
+{
+    return nAverageShort;
+}
+
+uint16_t get_average_long(void)
+{
+    return nAverageLong;
+}
+
+// cumulative average of count samples, where average holds the first count - 1
+static uint16_t running_average(const uint16_t average, const uint16_t sample, const uint8_t count)
+{
+    if (sample >= average)
+    {
+        return average + (sample - average) / count;
+    }
+
+    return average - (average - sample) / count;
+}
+
+// duration at position within the pending frame, position zero is the gap preceding the frame
+static uint16_t frame_timing(const uint8_t position)
+{
+    uint8_t index;
+
+    if (position == 0)
+    {
+        return frameGap;
+    }
+
+    // frameStart + position can exceed 255 with 64 bit frames, so wrap without forming the sum
+    if (position >= RCSWITCH_MAX_CHANGES - frameStart)
+    {
+        index = position - (RCSWITCH_MAX_CHANGES - frameStart);
+    }
+    else
+    {
+        index = frameStart + position;
+    }
+
+#if RCSWITCH_LOG_TIMINGS == 1
+    {
+        const uint8_t compact  = timings[index];
+        const uint8_t exponent = compact >> 5;
+
+        // below 64 units the value is stored as is
+        if (exponent <= 1)
+        {
+            return (uint16_t)compact << RCSWITCH_LOG_SHIFT;
+        }
+
+        // restore the leading one of the mantissa and add half of the bits dropped by the capture interrupt
+        return (((uint16_t)((compact & 0x1F) | 0x20) << (exponent - 1)) + (1 << (exponent - 2))) << RCSWITCH_LOG_SHIFT;
+    }
+#else
+    return (uint16_t)timings[index] << RCSWITCH_TIMING_SHIFT;
+#endif
+}
+
+
+// inclusive acceptance window for one pulse [highMin, highMin + highSpan], [lowMin, lowMin + lowSpan]
+// stored as start and span so a duration is checked with one subtraction and one unsigned compare
+struct PulseWindow
+{
+    uint16_t highMin;
+    uint16_t highSpan;
+    uint16_t lowMin;
+    uint16_t lowSpan;
+};
+
+// same limits as abs(duration - delay * factor) < delayTolerance
+static void window_limits(uint16_t* min, uint16_t* span, const unsigned int delay, const uint8_t factor, const unsigned int delayTolerance)
+{
+    const unsigned long expected = (unsigned long)delay * factor;
+    unsigned long lower = 0;
+    unsigned long upper = expected + delayTolerance - 1;
+
+    if (expected >= delayTolerance)
+    {
+        lower = expected - delayTolerance + 1;
+    }
+
+    if (upper > 0xFFFF)
+    {
+        upper = 0xFFFF;
+    }
+
+    *min  = lower;
+    *span = upper - lower;
+}
+
+static void pulse_window(struct PulseWindow* window, const struct HighLow* factors, const unsigned int delay, const unsigned int delayTolerance)
+{
+    window_limits(&window->highMin, &window->highSpan, delay, factors->high, delayTolerance);
+    window_limits(&window->lowMin,  &window->lowSpan,  delay, factors->low,  delayTolerance);
+}
 
 bool receive_protocol(const int p, unsigned int changeCount)
 {
     // FIXME: do we copy to ram from flash so check is faster in loops below?
     struct Protocol pro;
+    
+    // expected zero and one pulses of this frame, computed once from the sync length
+    struct PulseWindow zero;
+    struct PulseWindow one;
+
+    // ignore very short transmissions: no device sends them, so this must be noise
+    if (changeCount <= 7)
+    {
+        return false;
+    }
 
     // FIXME: we should probably check for out of bound index e.g. p = 0
     memcpy(&pro, &protocols[p-1], sizeof(struct Protocol));
     
-    unsigned long code = 0;
-    
     // assuming the longer pulse length is the pulse captured in timings[0]
     const unsigned int syncLengthInPulses = ((pro.syncFactor.low) > (pro.syncFactor.high)) ? (pro.syncFactor.low) : (pro.syncFactor.high);
-    const unsigned int delay = timings[0] / syncLengthInPulses;
+    const unsigned int delay = frame_timing(0) / syncLengthInPulses;
     const unsigned int delayTolerance = delay * get_received_tolerance() / 100;
     
+    // nothing can be closer than zero
+    if (delayTolerance == 0)
+    {
+        return false;
+    }
+
+    pulse_window(&zero, &pro.zero, delay, delayTolerance);
+    pulse_window(&one,  &pro.one,  delay, delayTolerance);
     
     /* For protocols that start low, the sync period looks like
      *               _________
@@ -123,17 +346,39 @@ bool receive_protocol(const int p, unsigned int changeCount)
      * The 2nd saved duration starts the data
      */
     const unsigned int firstDataTiming = (pro.invertedSignal) ? (2) : (1);
+    
+    // one bit for each pair of durations
+    const uint8_t bitLength = (changeCount - firstDataTiming) / 2;
+    
+    // RCSWITCH_MAX_CHANGES leaves room for the sync of inverted protocols,
+    // so a non-inverted protocol can see one bit more than decodedData[] holds
+    if (bitLength > RCSWITCH_MAX_DATA_BITS)
+    {
+        return false;
+    }
+    
+    // bits are collected into whole bytes, starting with leading zeros so that the code ends up right aligned
+    uint8_t code = 0;
+    uint8_t bitsInCode = (8 - (bitLength & 0x07)) & 0x07;
+    uint8_t* data = decodedData;
+    
+    // shorter and longer duration of each bit are summed up for the averages
+    uint32_t shortSum = 0;
+    uint32_t longSum  = 0;
 
     for (unsigned int i = firstDataTiming; i < changeCount - 1; i += 2)
     {
         code <<= 1;
         
-        if (abs(timings[i] - delay * pro.zero.high) < delayTolerance &&
-            abs(timings[i + 1] - delay * pro.zero.low) < delayTolerance) {
+        const uint16_t first  = frame_timing(i);
+        const uint16_t second = frame_timing(i + 1);
+
+        if ((uint16_t)(first - zero.highMin) <= zero.highSpan &&
+            (uint16_t)(second - zero.lowMin) <= zero.lowSpan) {
             // zero
             
-        } else if (abs(timings[i] - delay * pro.one.high) < delayTolerance &&
-            abs(timings[i + 1] - delay * pro.one.low) < delayTolerance) {
+        } else if ((uint16_t)(first - one.highMin) <= one.highSpan &&
+            (uint16_t)(second - one.lowMin) <= one.lowSpan) {
             // one
             code |= 1;
             
@@ -141,31 +386,168 @@ bool receive_protocol(const int p, unsigned int changeCount)
             // failed
             return false;
         }
-    }
         
-    // ignore very short transmissions: no device sends them, so this must be noise
-    if (changeCount > 7)
-    {
-        nReceivedValue     = code;
-        nReceivedBitlength = (changeCount - 1) / 2;
-        nReceivedDelay     = delay;
-        nReceivedProtocol  = p;
+        if (first < second)
+        {
+            shortSum += first;
+            longSum  += second;
+        }
+        else
+        {
+            shortSum += second;
+            longSum  += first;
+        }
+        
+        bitsInCode++;
         
-        return true;
+        if (bitsInCode == 8)
+        {
+            *data = code;
+            data++;
+            bitsInCode = 0;
+        }
+    }
+    
+    decodedBitlength = bitLength;
+    decodedDelay     = delay;
+    decodedSync      = frame_timing(0);
+    decodedShort     = shortSum / bitLength;
+    decodedLong      = longSum  / bitLength;
+    
+    return true;
+}
+
+// takes over the frame matched last by receive_protocol() as received code and into the averages
+static void accept_frame(const uint8_t p)
+{
+    // previous code is still in nReceivedData, a rejected frame leaves it untouched
+    const uint8_t dataBytes = (decodedBitlength + 7) / 8;
+    // 16 bit int on sdcc, so the tolerance is compared with the distance instead of adding it to the average
+    const uint16_t syncDistance = (decodedSync > nAverageSync) ? (decodedSync - nAverageSync) : (nAverageSync - decodedSync);
+    bool sameCode = (p == nReceivedProtocol) && (decodedBitlength == nAveragedBitlength);
+    
+    if (memcmp(nReceivedData, decodedData, dataBytes) != 0)
+    {
+        sameCode = false;
+    }
+    
+    // same code from a remote with different timing starts over as well
+    if (syncDistance > nAverageSync / 8)
+    {
+        sameCode = false;
+    }
+    
+    memcpy(nReceivedData, decodedData, dataBytes);
+    
+    nReceivedBitlength = decodedBitlength;
+    nReceivedDelay     = decodedDelay;
+    nReceivedProtocol  = p;
+    nReceivedSync      = decodedSync;
+    
+    if (!sameCode)
+    {
+        nAveragedFrames    = 0;
+        nAveragedBitlength = decodedBitlength;
+        nAverageSync       = 0;
+        nAverageShort      = 0;
+        nAverageLong       = 0;
+    }
+    
+    if (nAveragedFrames < MAX_AVERAGED_FRAMES)
+    {
+        nAveragedFrames++;
+    }
+    
+    nAverageSync  = running_average(nAverageSync,  decodedSync,  nAveragedFrames);
+    nAverageShort = running_average(nAverageShort, decodedShort, nAveragedFrames);
+    nAverageLong  = running_average(nAverageLong,  decodedLong,  nAveragedFrames);
+}
+
+static uint8_t ratio_bin(const uint16_t duration, const uint16_t binWidth)
+{
+    const uint16_t bin = duration / binWidth;
+
+    return (bin < RATIO_BINS) ? bin : (RATIO_BINS - 1);
+}
+
+// protocols that receive_protocol() could accept for the pending frame
+static uint16_t candidate_protocols(void)
+{
+    const uint16_t binWidth = frame_timing(0) / RATIO_BINS;
+    uint16_t candidates;
+
+    // short frames are rejected by receive_protocol() anyway
+    if (frameChanges <= 7)
+    {
+        return 0;
+    }
+
+    // frame restarted after overflow instead of at a gap, so ratio means nothing
+    if (binWidth == 0)
+    {
+        return 0xFFFF;
+    }
+
+    candidates  = ratioCandidates[ratio_bin(frame_timing(1), binWidth)] & ~INVERTED_PROTOCOLS;
+    candidates |= ratioCandidates[ratio_bin(frame_timing(2), binWidth)] & INVERTED_PROTOCOLS;
+
+    return candidates;
+}
+
+bool decode_frame(void)
+{
+    unsigned int i;
+    uint16_t candidates;
+
+    if (!framePending)
+    {
+        return false;
+    }
+
+    candidates = candidate_protocols();
+
+    for (i = 1; i <= numProto; i++, candidates >>= 1)
+    {
+        if ((candidates & 0x01) == 0)
+        {
+#if defined(RCSWITCH_COUNT_CALLS)
+            rcswitchProtocolCallsAvoided++;
+#endif
+            continue;
+        }
+
+#if defined(RCSWITCH_COUNT_CALLS)
+        rcswitchProtocolCalls++;
+#endif
+
+        if (receive_protocol(i, frameChanges))
+        {
+            // receive succeeded for protocol i, unless durations were replaced by newer ones while matching
+            if (!frameOverwritten)
+            {
+                accept_frame(i);
+            }
+
+            break;
+        }
     }
 
-    return false;
+    framePending = false;
+
+    return true;
 }
 
 void capture_handler(const uint16_t currentCapture)
 {
     // FIXME: comment on meaning
-    const uint8_t gapMagicNumber  = 200;
+    const uint16_t gapMagicNumber  = US_TO_TICKS(200);
     const uint8_t repeatThreshold   = 2;
     
     // this eventually represents the level duration in microseconds (difference between edge transitions)
     // FIXME: we should probably comment on why this is long type once I remember
     unsigned long duration;
+    // gap of unknown length, which can not be compared with the gap before the frame
+    bool unmeasured;
     
 
     // rc-switch variables
@@ -173,6 +555,12 @@ void capture_handler(const uint16_t currentCapture)
     static uint8_t repeatCount = 0;
     static uint8_t changeCount = 0;
 
+    // ring position of next duration and of the gap which started the current frame
+    static uint8_t writeIndex = 0;
+    static uint8_t startIndex = 0;
+    // full resolution duration at startIndex
+    static uint16_t startGap = 0;
+
 
     //const unsigned int separationLimit = gRCSwitch.nSeparationLimit;
 
@@ -183,6 +571,24 @@ void capture_handler(const uint16_t currentCapture)
     //current = currentCapture;
     //duration = current - previous;
     
+    // reset counter on each edge detection so we avoid need to compute time difference
+    // and hopefully avoid situation where counter overflows and wraps around
+    // (first, so that the time spent below is not lost from the next duration)
+    clear_pca_counter();
+    
+#if CAPTURE_GLITCH_FILTER == 1
+    // short pulses are merged into the duration before, so that one is only passed on now
+    // (levels are not used by rcswitch)
+    if (!capture_filter(currentCapture, false))
+    {
+        return;
+    }
+    
+    duration = capture_filter_counts;
+#else
+    duration = currentCapture;
+#endif
+    
     // e.g., EFM8BB1
     // e.g. (1/(24500000))*(49/2) = 1      microsec
     // e.g. (1/(24500000/12))*2   = 0.9796 microsec
@@ -195,20 +601,27 @@ void capture_handler(const uint16_t currentCapture)
     // so inverse is counts * 3/2 = time
     // e.g., (1/(16000000/24)) * dec(0xFFFF) = 98.30 milliseconds maximum can be counted
     //duration = countsToTime(duration);
-    duration = countsToTime(currentCapture);
+    // with CAPTURE_NATIVE_TICKS the counts are used as they are, see capture_ticks.h
+    unmeasured = (duration == CAPTURE_GAP_COUNTS);
     
-    // reset counter on each edge detection so we avoid need to compute time difference
-    // and hopefully avoid situation where counter overflows and wraps around
-    clear_pca_counter();
+#if CAPTURE_NATIVE_TICKS == 0
+    duration = countsToTime(duration);
+    
+    // startGap keeps 16 bit microseconds, longer durations (up to 98 ms on OB38S003) are not compared either
+    if (duration > 0xFFFF)
+    {
+        unmeasured = true;
+    }
+#endif
     
     // from oscillscope readings it appears that first sync pulse of first radio packet is frequently not output properly by receiver
     // this could be because radio receiver needs to "warm up" (despite already being enabled?)
     // and it is known that radio packet transmissions are often repeated (between about four and twenty times) perhaps in part for this reason
-    if (duration > nSeparationLimit)
+    if (duration > nSeparationLimit || unmeasured)
     {
         // A long stretch without signal level change occurred. This could
         // be the gap between two transmission.
-        if (abs(duration - timings[0]) < gapMagicNumber)
+        if (!unmeasured && abs(duration - startGap) < gapMagicNumber)
         {
           // This long signal is close in length to the long signal which
           // started the previously recorded timings; this suggests that
@@ -219,13 +632,16 @@ void capture_handler(const uint16_t currentCapture)
           
           if (repeatCount == repeatThreshold)
           {
-            for(unsigned int i = 1; i <= numProto; i++)
+            // matching against protocols is slow, so leave it to decode_frame() in main loop
+            // if the previous frame is still waiting there, this one is dropped (it is a repeat anyway)
+            if (!framePending)
             {
-              if (receive_protocol(i, changeCount))
-              {
-                // receive succeeded for protocol i
-                break;
-              }
+                frameStart       = startIndex;
+                frameGap         = startGap;
+                frameChanges     = changeCount;
+                frameSlack       = RCSWITCH_MAX_CHANGES - changeCount;
+                frameOverwritten = false;
+                framePending     = true;
             }
             
             repeatCount = 0;
@@ -233,6 +649,9 @@ void capture_handler(const uint16_t currentCapture)
         }
         
         changeCount = 0;
+        startIndex  = writeIndex;
+        // zero never matches the next gap, so a frame after an unmeasured gap is not taken for a repeat
+        startGap    = unmeasured ? 0 : duration;
     }
 
     // detect overflow
@@ -240,9 +659,55 @@ void capture_handler(const uint16_t currentCapture)
     {
         changeCount = 0;
         repeatCount = 0;
+        startIndex  = writeIndex;
+        startGap    = duration;
+    }
+
+    // the ring wraps around onto the pending frame once free slots are used up
+    if (framePending)
+    {
+        if (frameSlack == 0)
+        {
+            frameOverwritten = true;
+        }
+        else
+        {
+            frameSlack--;
+        }
     }
 
-    timings[changeCount++] = duration;
+    // rounded to the compact unit, longer durations can only be gaps which are kept in startGap
+    if (duration >= MAX_COMPACT_TIMING)
+    {
+        timings[writeIndex] = 0xFF;
+    }
+    else
+    {
+#if RCSWITCH_LOG_TIMINGS == 1
+        uint16_t mantissa = (uint16_t)duration >> RCSWITCH_LOG_SHIFT;
+        uint8_t  exponent = 0;
+
+        // keep six significant bits, the exponent then adds 32 per halving above 63
+        while (mantissa >= 64)
+        {
+            mantissa >>= 1;
+            exponent++;
+        }
+
+        timings[writeIndex] = (uint8_t)mantissa + (exponent << 5);
+#else
+        timings[writeIndex] = (duration + (1 << (RCSWITCH_TIMING_SHIFT - 1))) >> RCSWITCH_TIMING_SHIFT;
+#endif
+    }
+    
+    writeIndex++;
+    
+    if (writeIndex >= RCSWITCH_MAX_CHANGES)
+    {
+        writeIndex = 0;
+    }
+    
+    changeCount++;
     
     // DEBUG: this is a decent way of seeing the actual timing on an oscilloscope
     //debug_pin01_toggle();
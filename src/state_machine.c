@@ -19,7 +19,7 @@
 // we try to borrow portisch uart protocol but in some cases it does not translate exactly
 // standard decoding 0xA4 is 12 bytes always
 // standard transmit 0xA5 is 12 bytes always
-// advanced sniffing 0xA6 is unsupported
+// advanced sniffing 0xA6 is not a command, but codes longer than the 24 bits 0xA4 can carry are reported in its format
 // (rcswitch is essentially doing a form of this anyway with 0xA4 because we compare measured timings to a table to look for match)
 // advanced transmit 0xA8 can take a variable data length
 // with sync, command, length, protocol index, and end, we will choose to support eight data bytes (64 bits) for a total of 13 bytes
@@ -404,18 +404,48 @@ void rf_state_machine(RF_COMMAND_T command)
     }
 }
 
+// report codes longer than 0xA4 can carry the way portisch reports advanced sniffing
+// AA A6 <length> <protocol index> <data> 55, protocol index is zero based like for 0xA8 and length includes it
+static void radio_rfin_advanced(void)
+{
+    const uint8_t* data = get_received_data();
+    uint8_t length = get_received_bytelength();
+    
+    putchar(RF_CODE_START);
+    putchar(RF_CODE_SNIFFING_ON);
+    putchar(length + 1);
+    putchar(get_received_protocol() - 1);
+    
+    while (length > 0)
+    {
+        putchar(*data);
+        data++;
+        length--;
+    }
+    
+    putchar(RF_CODE_STOP);
+}
+
 // FIXME: consider calling this from within state machine
 void radio_rfin(void)
 {
     uint16_t buckets[3];
+    const uint8_t* data;
+    uint8_t length;
+    
+    if (get_received_bitlength() > 24)
+    {
+        radio_rfin_advanced();
+        return;
+    }
     
-    // assumes standard PT226x timings
-    // FIXME: how to handle otherwise?
+    // measured timings averaged over the repeats received so far, so retransmitting with 0xA5 matches the remote
+    // short and long are the shorter and longer duration of each bit, which is what PT226x like 0xA5 sends
     // FIXME: handle inverted signal?
-    // FIXME: not sure if we should compute an average or something for repeats?
-    buckets[0] = timings[0];
-    buckets[1] = timings[0] / 31;
-    buckets[2] = buckets[1] * 3;
+    // sent in microseconds regardless of CAPTURE_NATIVE_TICKS
+    buckets[0] = TICKS_TO_US(get_average_sync());
+    buckets[1] = TICKS_TO_US(get_average_short());
+    buckets[2] = TICKS_TO_US(get_average_long());
 
                     
     // packet start sequence
@@ -433,11 +463,21 @@ void radio_rfin(void)
     putchar((buckets[2] >> 8) & 0xFF);
     putchar( buckets[2] & 0xFF);
     
-    // data
-    // FIXME: strange that shifting by ZERO works but omitting the shift does not
-    putchar((get_received_value() >> 16) & 0xFF);
-    putchar((get_received_value() >>  8) & 0xFF);
-    putchar((get_received_value() >>  0) & 0xFF);
+    // data, right aligned in three bytes
+    data   = get_received_data();
+    length = get_received_bytelength();
+    
+    for (uint8_t index = length; index < 3; index++)
+    {
+        putchar(0x00);
+    }
+    
+    while (length > 0)
+    {
+        putchar(*data);
+        data++;
+        length--;
+    }
     
     // packet stop
     putchar(RF_CODE_STOP);
@@ -461,9 +501,10 @@ void radio_decode_debug(void)
     
     // data
     putstring("d:0x");
-    puthex2((get_received_value() >> 16) & 0xFF);
-    puthex2((get_received_value() >>  8) & 0xFF);
-    puthex2((get_received_value() >>  0) & 0xFF);
+    for (uint8_t index = 0; index < get_received_bytelength(); index++)
+    {
+        puthex2(get_received_data()[index]);
+    }
     
     // newline
     putc('\r');
@@ -485,9 +526,8 @@ void radio_decode_timings(void)
         putchar(RF_CODE_START);
         putchar(0xAF);
         
-        // sync, low, high timings
-        putchar((timings[index] >> 8) & 0xFF);
-        putchar(timings[index] & 0xFF);
+        // compact timings, see RCSWITCH_TIMING_SHIFT
+        putchar(timings[index]);
     }
     
     putchar(RF_CODE_STOP);
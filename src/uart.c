@@ -40,6 +40,12 @@ __xdata static volatile uint8_t UART_Buffer_Write_Len = 0;
 // prefer to avoid storing in external ram to take advantage of bit addressable internal ram
 static volatile bool gTXFinished = true;
 
+#if RF_STATS == 1
+// bytes received by the interrupt and bytes queued for transmit, see rf_stats.h
+__xdata volatile uint16_t uart_rx_bytes = 0;
+__xdata uint16_t uart_tx_bytes = 0;
+#endif
+
 //-----------------------------------------------------------------------------
 // UART ISR Callbacks
 //-----------------------------------------------------------------------------
@@ -123,6 +129,8 @@ void uart_isr(void) __interrupt (UART0_VECTOR)
         UART_RX_Buffer[UART_RX_Buffer_Position] = getchar();
         UART_RX_Buffer_Position++;
 
+        STATS_INC(uart_rx_bytes);
+
         // set to beginning of buffer if end is reached
         if (UART_RX_Buffer_Position == UART_RX_BUFFER_SIZE)
         {
@@ -174,6 +182,12 @@ bool is_uart_tx_buffer_empty(void)
     return true;
 }
 
+// bytes uart_putc() can queue without overwriting bytes not yet sent
+uint8_t uart_tx_free(void)
+{
+    return UART_TX_BUFFER_SIZE - UART_Buffer_Write_Len;
+}
+
 
 //************************************************************************
 //Function: uart_getc()
@@ -222,7 +236,18 @@ void uart_putc(uint8_t txdata)
 
     UART_TX_Buffer[UART_TX_Buffer_Position] = txdata;
     UART_TX_Buffer_Position++;
+
+    // the interrupt decrements the length while bytes are sent, so do not let it interrupt the increment,
+    // callers that run with the serial interrupt disabled keep it disabled
+    const bool serialEnabled = is_serial_interrupt_enabled();
+    disable_serial_interrupt();
     UART_Buffer_Write_Len++;
+    if (serialEnabled)
+    {
+        enable_serial_interrupt();
+    }
+
+    STATS_INC(uart_tx_bytes);
 }
 
 void uart_put_command(uint8_t command)